@@ -0,0 +1,98 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: libFuzzer entry point running arbitrary bytes as ROMs
+ *
+ * Input layout: byte 0 picks the quirk profile, bytes 1-2 are the keypad
+ * held throughout (bit k for key k, little-endian) and the rest is the ROM,
+ * cut to what fits in memory. Each input runs for a fixed instruction
+ * budget on the interpreter and, on a second machine, through the JIT;
+ * the two must end in the same state. Both machines are reused across
+ * inputs through Processor::reload, so an iteration costs little more
+ * than the instructions it runs.
+ *
+ * Built with CHIP8_FUZZ_DRIVER, a main() runs each file named on the
+ * command line once, for compilers without libFuzzer.
+ *****************************************************************************/
+
+#include "Jit.hpp"
+#include "chip8.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+constexpr size_t HEADER_BYTES = 3;
+constexpr uint64_t CYCLE_BUDGET = 20000;
+constexpr double INSTRUCTIONS_PER_SECOND = 1000;
+
+struct Machines
+{
+    Processor interpreted;
+    Processor compiled;
+    Jit jit{compiled};
+};
+
+void prepare(Processor &chip8, Quirks::Profile profile, uint16_t keys, const uint8_t *rom, size_t size)
+{
+    chip8.set_quirks(profile);
+    chip8.reload(rom, size);
+    chip8.set_instructions_per_second(INSTRUCTIONS_PER_SECOND);
+    chip8.seed_random(0);
+    for (unsigned int k = 0; k < NUM_KEYS; ++k)
+        chip8.keypad[k] = (keys >> k) & 1u;
+}
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    // Built once: a fresh Jit maps its code buffer and allocates its block
+    // tables, which would dominate the time spent on each input
+    static Machines *machines = new Machines();
+
+    if (size < HEADER_BYTES)
+        return 0;
+    auto profile = static_cast<Quirks::Profile>(data[0] % static_cast<uint8_t>(Quirks::Profile::COUNT));
+    uint16_t keys = static_cast<uint16_t>(data[1] | (data[2] << 8));
+    const uint8_t *rom = data + HEADER_BYTES;
+    size_t romSize = std::min<size_t>(size - HEADER_BYTES, Quirks::MemoryBytes(Quirks::Of(profile)) - START_ADDRESS);
+
+    prepare(machines->interpreted, profile, keys, rom, romSize);
+    prepare(machines->compiled, profile, keys, rom, romSize);
+    machines->jit.flush();
+
+    RunResult a = machines->interpreted.run(CYCLE_BUDGET);
+    RunResult b = machines->jit.run(CYCLE_BUDGET);
+    if (a.cycles != b.cycles ||
+        machines->interpreted.state_hash() != machines->compiled.state_hash())
+    {
+        std::fprintf(stderr, "Interpreter and JIT disagree: profile %s, cycles %llu / %llu\n",
+                     Quirks::Name(profile), static_cast<unsigned long long>(a.cycles),
+                     static_cast<unsigned long long>(b.cycles));
+        std::abort();
+    }
+    return 0;
+}
+
+#ifdef CHIP8_FUZZ_DRIVER
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file.is_open())
+        {
+            std::fprintf(stderr, "Failed to open input: %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        std::vector<uint8_t> input((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    return EXIT_SUCCESS;
+}
+#endif
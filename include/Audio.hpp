@@ -0,0 +1,146 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Beep and XO-CHIP pattern synthesis, live or to a WAV file
+ *****************************************************************************/
+#pragma once
+
+#include "chip8.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// What the sound hardware does for one emulated frame, taken after it ran:
+// the buzzer sounds for the next 1/60 s while the sound timer is non-zero
+struct AudioFrame
+{
+    uint8_t soundTimer;
+    uint8_t pitch;
+    // A pattern was loaded with F002; without one the buzzer is a plain
+    // square wave, as on machines that have no pattern audio
+    bool patterned;
+    uint8_t pattern[AUDIO_PATTERN_BYTES];
+
+    static AudioFrame Capture(const Processor &cpu);
+};
+
+// Turns AudioFrames into signed 16-bit mono samples. The phase carries over
+// from frame to frame, so a tone held across frames has no seams.
+class AudioSynth
+{
+  public:
+    static constexpr double BEEP_HZ = 440.0;
+
+    AudioSynth(int sampleRate, double volume);
+    int SampleRate() const { return sampleRate; }
+
+    void Set(const AudioFrame &frame);
+    void Silence();
+    // Length of the next frame in samples; over 60 frames these add up to
+    // exactly one second
+    size_t FrameSamples();
+    void Render(int16_t *out, size_t count);
+
+  private:
+    int sampleRate;
+    int16_t amplitude;
+    unsigned int remainder{}; // sampleRate * frames mod 60
+    bool sounding{};
+    bool patterned{};
+    uint8_t pattern[AUDIO_PATTERN_BYTES]{};
+    double phase{}; // In pattern bits, or in beep cycles
+    double step{};
+};
+
+// Hands AudioFrames from the emulating thread to an audio callback. Push
+// copies one frame into a preallocated single-producer/single-consumer
+// ring; Render never locks, allocates or waits, so it is safe to call from
+// a real-time audio thread.
+//
+// Latency is the device buffer plus the frames kept queued ahead of it.
+// Playback starts once `leadFrames` are queued; a backlog beyond that (from
+// fast-forward, or a host stall) is skipped instead of played late. When
+// the queue runs dry the current frame is held for one frame length, then
+// the output falls silent until the lead builds up again.
+class AudioStream
+{
+  public:
+    struct Options
+    {
+        int sampleRate = 48000;
+        unsigned int bufferSamples = 512; // Per callback; smaller is sooner
+        unsigned int leadFrames = 1;      // At least 1 for a live device
+        size_t capacity = 16;             // Frames the ring holds, rounded up to a power of two
+        double volume = 0.2;
+    };
+
+    AudioStream() = default;
+
+    AudioStream(const AudioStream &) = delete;
+    AudioStream &operator=(const AudioStream &) = delete;
+
+    // Allocates the ring; call before the consumer starts
+    void Open(const Options &options);
+    bool IsOpen() const { return !ring.empty(); }
+    const Options &GetOptions() const { return options; }
+
+    // Producer side: call after each emulated frame
+    void Push(const Processor &cpu);
+    // Consumer side: fills `count` samples
+    void Render(int16_t *out, size_t count);
+
+    // Frames the ring had no room for, and times the callback ran dry
+    uint64_t Dropped() const { return dropped; }
+    uint64_t Underruns() const { return underruns.load(std::memory_order_relaxed); }
+
+  private:
+    void next();
+
+    Options options;
+    std::vector<AudioFrame> ring;
+    size_t mask{};
+    uint64_t dropped{};
+
+    // Consumer state
+    AudioSynth synth{48000, 0.0};
+    size_t remaining{};
+    bool priming{true};
+    bool held{};
+    std::atomic<uint64_t> underruns{};
+
+    alignas(64) std::atomic<uint64_t> head{};
+    alignas(64) std::atomic<uint64_t> tail{};
+};
+
+// Writes the audio of an emulation to a 16-bit mono PCM WAV file, one
+// emulated frame at a time, with no device and no real-time pacing
+class WavWriter
+{
+  public:
+    WavWriter() = default;
+    ~WavWriter() { Close(); }
+
+    WavWriter(const WavWriter &) = delete;
+    WavWriter &operator=(const WavWriter &) = delete;
+
+    // Returns 0 on success
+    int Open(const char *filename, int sampleRate = 48000, double volume = 0.2);
+    bool IsOpen() const { return out != nullptr; }
+    // Fills in the header sizes; returns 0 if everything was written
+    int Close();
+
+    // Call after each emulated frame
+    void Write(const Processor &cpu);
+
+  private:
+    std::FILE *out{};
+    AudioSynth synth{48000, 0.0};
+    std::vector<int16_t> samples;
+    std::vector<uint8_t> bytes;
+    uint64_t written{}; // Samples
+    bool failed{};
+};
@@ -0,0 +1,91 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Static control-flow analysis of a ROM image
+ *****************************************************************************/
+#pragma once
+
+#include "chip8.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Walks a ROM from START_ADDRESS without running it, following jumps,
+// calls, returns and skips, and splits what it reaches into basic blocks.
+// Along the way I and the registers are tracked as constants within each
+// block, which is enough to resolve the common `LD I, sprite` ... `DRW`
+// and `LD I, table` ... `LD [I], Vx` patterns: drawn bytes are marked as
+// sprites, other loads as data, and every store records whether it lands
+// on code.
+//
+// The walk is profile-independent: a skip may step over two bytes or all
+// four of F000 NNNN, so both are followed. BNNN's target depends on a
+// register and ends its path; code reached only through it stays unknown.
+namespace ControlFlow
+{
+// What a byte of the image was found to be
+enum class Byte : uint8_t
+{
+    UNKNOWN, // Neither reached as code nor referenced through I
+    CODE,    // First byte of a reachable instruction
+    OPERAND, // Any later byte of one
+    SPRITE,  // Drawn by DXYN with I set in the same block
+    DATA     // Otherwise read or written through a known I
+};
+
+// How a block hands over control
+enum class Terminator : uint8_t
+{
+    FALLTHROUGH, // Runs into the next block, which something else jumps to
+    JUMP,        // 1NNN
+    CALL,        // 2NNN; resumes at the following instruction
+    RETURN,      // 00EE
+    SKIP,        // Conditional skip: the next instruction or the one after
+    INDIRECT,    // BNNN
+    HALT,        // 00FD, or a word that decodes to nothing
+    END          // Ran off the end of the image
+};
+
+struct Block
+{
+    uint16_t start;
+    uint16_t last;  // Address of the final instruction
+    uint16_t end;   // One past the last byte
+    Terminator terminator;
+    uint16_t target; // JUMP and CALL destination, BNNN's base
+    std::vector<uint16_t> successors; // Within the image or not
+};
+
+// An FX33, FX55 or 5XY2 and the bytes it writes, when I is known there
+struct Store
+{
+    uint16_t pc;
+    Op op;
+    bool known;
+    uint16_t first; // Inclusive range; meaningful when known
+    uint16_t last;
+    bool hitsCode;  // The range overlaps reachable instructions
+};
+
+struct Graph
+{
+    std::vector<Byte> bytes;          // One per image byte, from START_ADDRESS
+    std::vector<Block> blocks;        // Ordered by start address
+    std::vector<uint16_t> subroutines; // CALL targets, ascending
+    std::vector<Store> stores;        // In block order
+
+    Byte At(uint32_t address) const
+    {
+        uint32_t offset = address - START_ADDRESS;
+        return address >= START_ADDRESS && offset < bytes.size() ? bytes[offset] : Byte::UNKNOWN;
+    }
+    // The block starting exactly at `address`, or nullptr
+    const Block *BlockAt(uint16_t address) const;
+    // Stores that can overwrite code, or whose target is not known
+    size_t SuspectStores() const;
+};
+
+Graph Analyse(const uint8_t *rom, size_t size);
+} // namespace ControlFlow
@@ -0,0 +1,32 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Names and assembly text for decoded instructions
+ *****************************************************************************/
+#pragma once
+
+#include "ControlFlow.hpp"
+#include "chip8.hpp"
+#include <ostream>
+#include <string>
+
+namespace Disassembler
+{
+// The handler's name as spelled in chip8.hpp, e.g. "OP_8xy4"
+const char *OpName(Op op);
+// Parses an OpName; case-insensitive, the "OP_" prefix optional
+bool ParseOpName(const char *name, Op &op);
+
+// Assembly text in the usual mnemonics, e.g. "ADD V3, V4" or "DRW V0, V1, 5".
+// Undecodable words come out as data ("DW 0x1234"). F000 takes its 16-bit
+// operand from the following word, which this does not see.
+std::string Format(uint16_t opcode);
+
+// Annotated listing of a whole image as analysed by ControlFlow::Analyse:
+// each block headed by its range and predecessors, each instruction with
+// its handler name, successors and any store that may hit code; sprites
+// drawn as pixels, everything else as bytes
+void Listing(std::ostream &out, const uint8_t *rom, size_t size, const ControlFlow::Graph &graph);
+} // namespace Disassembler
@@ -0,0 +1,189 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Display geometry and the word-level drawing and scrolling
+ *              kernels shared by Processor and ProcessorBatch
+ *****************************************************************************/
+#pragma once
+
+#include <cstdint>
+
+const unsigned int VIDEO_WIDTH = 64;  // Low resolution
+const unsigned int VIDEO_HEIGHT = 32;
+const unsigned int HIRES_WIDTH = 128; // SUPER-CHIP / XO-CHIP high resolution
+const unsigned int HIRES_HEIGHT = 64;
+const unsigned int DISPLAY_PLANES = 2; // XO-CHIP bit-planes
+const unsigned int ROW_WORDS = HIRES_WIDTH / 64;
+
+// One bit per pixel: plane p, row y, word w, with bit 63 of word 0 the
+// leftmost pixel. Low resolution only uses rows below VIDEO_HEIGHT and word 0.
+typedef uint64_t DisplayBits[DISPLAY_PLANES][HIRES_HEIGHT][ROW_WORDS];
+
+// Every kernel reaches the display through `word(plane, y, w)`, returning a
+// uint64_t&, so the same code serves a Processor's array and a lane of
+// ProcessorBatch's structure-of-arrays. Whole 64-pixel words move at once;
+// nothing here loops over pixels.
+namespace Display
+{
+inline unsigned int Width(bool hires) { return hires ? HIRES_WIDTH : VIDEO_WIDTH; }
+inline unsigned int Height(bool hires) { return hires ? HIRES_HEIGHT : VIDEO_HEIGHT; }
+inline unsigned int Words(bool hires) { return hires ? ROW_WORDS : 1; }
+
+// Lines up a sprite row (left-aligned in `sprite`, at most 16 pixels) at
+// column x of a row `width` pixels wide. Pixels past the right edge are
+// dropped or, when wrapping, come back in at the left.
+template <bool Wrap>
+inline void Place(uint64_t sprite, unsigned int x, unsigned int width, uint64_t out[ROW_WORDS])
+{
+    uint64_t first = x < 64 ? sprite >> x : 0;
+    uint64_t second = x == 0 ? 0 : (x < 64 ? sprite << (64u - x) : sprite >> (x - 64u));
+
+    if (width == 64)
+    {
+        // Everything in the second word fell off the right edge
+        if (Wrap)
+            first |= second;
+        second = 0;
+    }
+    else if (Wrap && x > 64)
+    {
+        first |= sprite << (128u - x);
+    }
+
+    out[0] = first;
+    out[1] = second;
+}
+
+// XORs a sprite into each plane selected in `planes`, each plane taking
+// the next run of sprite bytes. n rows of 8 pixels, or 16x16 when n is 0.
+// Bytes come from `mem(address)`; drawing stops at the end of memory or,
+// unless wrapping, at the bottom edge. Returns whether any lit pixel was
+// turned off and ORs the rows written into `dirty`.
+template <bool Wrap, typename Word, typename Memory>
+bool Draw(Word word, Memory mem, unsigned int memorySize, bool hires, unsigned int planes,
+          unsigned int index, unsigned int x, unsigned int y, unsigned int n, uint64_t &dirty)
+{
+    const unsigned int width = Width(hires);
+    const unsigned int height = Height(hires);
+    const unsigned int words = Words(hires);
+    const unsigned int rows = n ? n : 16;
+    const unsigned int rowBytes = n ? 1 : 2;
+    x %= width;
+    y %= height;
+
+    bool collided = false;
+    unsigned int address = index;
+    for (unsigned int p = 0; p < DISPLAY_PLANES; ++p)
+    {
+        if (!((planes >> p) & 1u))
+            continue;
+
+        for (unsigned int r = 0; r < rows; ++r)
+        {
+            unsigned int source = address + r * rowBytes;
+            unsigned int py = y + r;
+            if (Wrap)
+                py %= height;
+            if (source + rowBytes > memorySize || py >= height)
+                break;
+
+            uint64_t sprite = n ? static_cast<uint64_t>(mem(source)) << 56u
+                                : static_cast<uint64_t>((mem(source) << 8u) | mem(source + 1)) << 48u;
+            uint64_t bits[ROW_WORDS];
+            Place<Wrap>(sprite, x, width, bits);
+
+            for (unsigned int w = 0; w < words; ++w)
+            {
+                uint64_t &cell = word(p, py, w);
+                if (cell & bits[w])
+                    collided = true;
+                cell ^= bits[w];
+            }
+            if (bits[0] | bits[1])
+                dirty |= 1ull << py;
+        }
+        address += rows * rowBytes;
+    }
+    return collided;
+}
+
+template <typename Word>
+void Clear(Word word, unsigned int planes)
+{
+    for (unsigned int p = 0; p < DISPLAY_PLANES; ++p)
+    {
+        if (!((planes >> p) & 1u))
+            continue;
+        for (unsigned int y = 0; y < HIRES_HEIGHT; ++y)
+        {
+            for (unsigned int w = 0; w < ROW_WORDS; ++w)
+                word(p, y, w) = 0;
+        }
+    }
+}
+
+// Moves the selected planes n rows down (negative: up), filling with blank
+// rows; whole words are copied
+template <typename Word>
+void ScrollVertical(Word word, bool hires, unsigned int planes, int n)
+{
+    const int height = static_cast<int>(Height(hires));
+    const unsigned int words = Words(hires);
+
+    for (unsigned int p = 0; p < DISPLAY_PLANES; ++p)
+    {
+        if (!((planes >> p) & 1u))
+            continue;
+
+        // Walk away from the direction of travel so sources are read first
+        for (int i = 0; i < height; ++i)
+        {
+            int y = n > 0 ? height - 1 - i : i;
+            int from = y - n;
+            for (unsigned int w = 0; w < words; ++w)
+                word(p, y, w) = (from >= 0 && from < height) ? word(p, from, w) : 0;
+        }
+    }
+}
+
+// Moves the selected planes n < 64 pixels right (negative: left) as a
+// multi-word shift of every row
+template <typename Word>
+void ScrollHorizontal(Word word, bool hires, unsigned int planes, int n)
+{
+    const unsigned int height = Height(hires);
+    const unsigned int shift = static_cast<unsigned int>(n < 0 ? -n : n);
+    if (shift == 0)
+        return;
+
+    for (unsigned int p = 0; p < DISPLAY_PLANES; ++p)
+    {
+        if (!((planes >> p) & 1u))
+            continue;
+
+        for (unsigned int y = 0; y < height; ++y)
+        {
+            uint64_t &first = word(p, y, 0);
+            if (!hires)
+            {
+                first = n > 0 ? first >> shift : first << shift;
+                continue;
+            }
+
+            uint64_t &second = word(p, y, 1);
+            if (n > 0)
+            {
+                second = (second >> shift) | (first << (64u - shift));
+                first >>= shift;
+            }
+            else
+            {
+                first = (first << shift) | (second >> (64u - shift));
+                second <<= shift;
+            }
+        }
+    }
+}
+} // namespace Display
@@ -0,0 +1,113 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Streams emulated frames to a file or pipe without SDL
+ *****************************************************************************/
+#pragma once
+
+#include "chip8.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Captures the display once per emulated frame and writes it out on a
+// background thread. Capture copies the 2 KiB of bit-planes into a
+// preallocated single-producer/single-consumer ring, or only notes a repeat
+// when no instruction has written the display since the last capture; all
+// conversion and I/O happen on the writer thread.
+//
+// Every format has a fixed 128x64 geometry, low-resolution frames being
+// pixel-doubled, so a stream survives 00FE/00FF mode switches:
+//   RAW  1 bit per pixel, rows MSB first, 1 = lit (ffmpeg's monob)
+//   Y4M  YUV4MPEG2 greyscale at 60 Hz / every, ready to pipe to an encoder
+//   PBM  a P4 image per frame, concatenated (netpbm reads them in turn)
+// With delta, RAW frames carry only the rows that changed; the layout is
+// documented in FrameSink.cpp.
+class FrameSink
+{
+  public:
+    enum class Format : uint8_t
+    {
+        RAW,
+        Y4M,
+        PBM
+    };
+
+    struct Options
+    {
+        Format format = Format::Y4M;
+        bool delta = false;      // RAW only
+        unsigned int skip = 0;   // Leading frames to leave out
+        unsigned int every = 1;  // Then keep one frame in `every`
+        // When the writer falls behind, wait for it instead of dropping the
+        // frame; offline tools want every frame, a live frontend never waits
+        bool wait = false;
+        size_t capacity = 64;    // Frames the ring holds, rounded up to a power of two
+    };
+
+    FrameSink() = default;
+    ~FrameSink() { Close(); }
+
+    FrameSink(const FrameSink &) = delete;
+    FrameSink &operator=(const FrameSink &) = delete;
+
+    // "-" writes to standard output. Returns 0 on success.
+    int Open(const char *filename, const Options &options);
+    bool IsOpen() const { return writer.joinable(); }
+    // Writes out every captured frame and stops the writer; returns 0 if
+    // everything reached the output
+    int Close();
+
+    // Producer side: call from the emulating thread after each emulated
+    // frame, e.g. after Processor::run_until_frame
+    void Capture(const Processor &cpu);
+
+    // Frames passed to Capture, and those dropped because the ring was
+    // full; a dropped frame is written as a repeat of the one before it
+    uint64_t Frames() const { return frames; }
+    uint64_t Dropped() const { return dropped; }
+
+    // "raw", "y4m" or "pbm"; ParseFormat returns false for anything else
+    static bool ParseFormat(const char *name, Format &format);
+
+  private:
+    struct Slot
+    {
+        uint64_t number;  // Position among the kept frames
+        bool repeat;      // Display unchanged; `display` was not copied
+        bool hires;
+        DisplayBits display;
+    };
+
+    void drain();
+    void write(const Slot &slot);
+
+    Options options;
+    std::FILE *out{};
+    std::vector<Slot> ring;
+    size_t mask{};
+    std::thread writer;
+    bool failed{};
+
+    // Producer state
+    uint64_t frames{};
+    uint64_t kept{};
+    uint64_t dropped{};
+    bool captured{};
+    uint32_t lastGeneration{};
+    bool lastHires{};
+
+    // Writer state: the previous frame, at 128x64 per plane
+    uint64_t shown[DISPLAY_PLANES][HIRES_HEIGHT][ROW_WORDS]{};
+    uint64_t written{};
+    std::vector<uint8_t> buffer;
+
+    alignas(64) std::atomic<uint64_t> head{};
+    alignas(64) std::atomic<uint64_t> tail{};
+    std::atomic<bool> stopping{};
+};
@@ -0,0 +1,76 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Fixed-size histogram of millisecond timings
+ *****************************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <ostream>
+
+// Collects durations such as frame times or input latency without growing:
+// samples land in 0.1 ms buckets up to 100 ms, anything longer in the last
+// one. Percentiles are therefore accurate to a bucket.
+class FrameStats
+{
+  public:
+    void Add(double milliseconds)
+    {
+        if (milliseconds < 0)
+            milliseconds = 0;
+
+        unsigned int bucket = static_cast<unsigned int>(milliseconds / BUCKET_MS);
+        if (bucket >= BUCKETS)
+            bucket = BUCKETS - 1;
+        ++buckets[bucket];
+
+        if (count == 0 || milliseconds < min)
+            min = milliseconds;
+        if (milliseconds > max)
+            max = milliseconds;
+        sum += milliseconds;
+        ++count;
+    }
+
+    uint64_t Count() const { return count; }
+
+    // Upper edge of the bucket holding the given fraction of samples
+    double Percentile(double fraction) const
+    {
+        uint64_t target = static_cast<uint64_t>(fraction * static_cast<double>(count));
+        uint64_t seen = 0;
+        for (unsigned int i = 0; i < BUCKETS; ++i)
+        {
+            seen += buckets[i];
+            if (seen > target)
+                return (i + 1) * BUCKET_MS;
+        }
+        return max;
+    }
+
+    void Print(std::ostream &out, const char *label) const
+    {
+        char line[160];
+        if (count == 0)
+            std::snprintf(line, sizeof(line), "%-16s no samples\n", label);
+        else
+            std::snprintf(line, sizeof(line),
+                          "%-16s n=%llu mean=%.2fms min=%.2fms p50=%.1fms p99=%.1fms max=%.2fms\n",
+                          label, static_cast<unsigned long long>(count), sum / static_cast<double>(count),
+                          min, Percentile(0.50), Percentile(0.99), max);
+        out << line;
+    }
+
+  private:
+    static constexpr double BUCKET_MS = 0.1;
+    static constexpr unsigned int BUCKETS = 1000;
+
+    uint64_t buckets[BUCKETS]{};
+    uint64_t count{};
+    double sum{};
+    double min{};
+    double max{};
+};
@@ -0,0 +1,97 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Records keypad sessions and replays them deterministically
+ *****************************************************************************/
+#pragma once
+
+#include "chip8.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <vector>
+
+// A session is everything needed to rerun a frontend session exactly: the
+// machine settings from power-on, then each keypad change stamped with the
+// instruction count it took effect at. Emulated time is a pure function of
+// instruction count, so a replay needs no wall clock, no SDL and no pacing.
+// The file layout is documented in InputLog.cpp.
+struct SessionInfo
+{
+    uint64_t seed{};
+    Random::Engine engine{Random::Engine::XOSHIRO};
+    Quirks::Profile quirks{Quirks::Profile::MODERN};
+    double instructionsPerSecond{700};
+    uint64_t romHash{}; // FNV-1a of the ROM image, checked on replay
+    uint32_t romSize{};
+
+    // Brings a freshly constructed machine with the ROM loaded into the
+    // recorded configuration
+    void Apply(Processor &cpu) const;
+    static uint64_t HashRom(const uint8_t *data, size_t size);
+};
+
+class InputRecorder
+{
+  public:
+    // Returns 0 on success
+    int Open(const char *filename, const SessionInfo &info);
+    bool IsOpen() const { return file.is_open(); }
+
+    // Call whenever the keypad may have changed, before the machine runs
+    // on; only changes are written
+    void Sample(uint64_t cycle, const uint8_t *keypad);
+    // Stamps the end of the session; returns 0 if everything was written
+    int Close(uint64_t cycle);
+
+  private:
+    void writeRecord(uint64_t cycle, bool end);
+
+    std::ofstream file;
+    uint64_t lastCycle{};
+    uint16_t lastKeys{};
+};
+
+class InputReplay
+{
+  public:
+    struct Event
+    {
+        uint64_t cycle;
+        uint16_t keys; // Bit k set while key k is down
+    };
+
+    // Reads and validates a whole session file; returns 0 on success
+    int Load(const char *filename);
+
+    const SessionInfo &Info() const { return info; }
+    const std::vector<Event> &Events() const { return events; }
+    uint64_t EndCycle() const { return endCycle; }
+
+    // Drives cpu from its current instruction count to the end of the
+    // session as fast as the host allows. `run` executes exactly the
+    // given number of instructions, e.g. Processor::run or Jit::run.
+    template <typename Runner>
+    void Play(Processor &cpu, Runner run) const;
+
+  private:
+    SessionInfo info;
+    std::vector<Event> events;
+    uint64_t endCycle{};
+};
+
+template <typename Runner>
+void InputReplay::Play(Processor &cpu, Runner run) const
+{
+    for (const Event &event : events)
+    {
+        if (event.cycle > cpu.get_cycles())
+            run(event.cycle - cpu.get_cycles());
+        for (unsigned int k = 0; k < NUM_KEYS; ++k)
+            cpu.keypad[k] = (event.keys >> k) & 1u;
+    }
+    if (endCycle > cpu.get_cycles())
+        run(endCycle - cpu.get_cycles());
+}
@@ -0,0 +1,96 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: x86-64 basic-block JIT that drives a Processor
+ *****************************************************************************/
+#pragma once
+
+#include "ControlFlow.hpp"
+#include "chip8.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+// Translates straight-line runs of register/ALU instructions, jumps, skips,
+// calls and returns, and the FX1E/FX33/FX55/FX65 memory instructions into
+// native x86-64 code. Anything the translator does not handle (draws, keys,
+// the extended instructions) is executed by the Processor's own
+// interpreter, which stays the reference implementation. On other hosts, or
+// if executable memory cannot be mapped, every instruction simply goes to
+// the interpreter.
+//
+// The Jit snapshots the program when blocks are compiled, so construct it
+// after load_rom (or call flush() after loading a new ROM). Blocks follow
+// the Processor's quirk profile and are retranslated when it changes.
+class Jit
+{
+  public:
+    explicit Jit(Processor &cpu);
+    ~Jit();
+
+    Jit(const Jit &) = delete;
+    Jit &operator=(const Jit &) = delete;
+
+    // Execute exactly `cycles` instructions in emulated time, ticking the
+    // timers at frame boundaries and skipping idle loops like Processor::run
+    RunResult run(uint64_t cycles);
+    void flush();
+    // Translate every block a static analysis of the loaded ROM found, so
+    // the first pass through each one does not pay for compiling it
+    void prebuild(const ControlFlow::Graph &graph);
+    bool enabled() const { return code != nullptr; }
+
+  private:
+    // Native block entry: takes &cpu.registers[0] and the guest memory
+    // bytes, returns the next pc
+    typedef uint32_t (*BlockFn)(uint8_t *base, uint8_t *memory);
+    typedef uint64_t (Jit::*ExecuteFn)(uint64_t cycles);
+
+    enum class State : uint8_t
+    {
+        EMPTY,        // Not compiled yet
+        NATIVE,       // entry points at translated code
+        INTERPRETED,  // First instruction is not translatable
+    };
+
+    struct Block
+    {
+        BlockFn entry;
+        uint32_t end;   // One past the last guest byte the block covers
+        uint8_t count;  // Guest instructions executed per entry
+        State state;
+        uint8_t stored;      // Bytes the closing FX33/FX55 stores at I, 0 for none
+        uint8_t storeRewind; // How far that store moved I past its first byte
+    };
+
+    static const unsigned int MAX_BLOCK_INSTRUCTIONS = 64;
+    static const size_t CODE_BUFFER_BYTES = 1 << 20;
+    static const size_t MAX_BLOCK_BYTES = 4096;
+    static const size_t BLOCK_FRAME_BYTES = 512; // Prologue and epilogue
+    static const unsigned int PAGE_BITS = 8;
+
+    Block &lookup(uint16_t pc);
+    Block &lookupPartial(uint16_t pc, unsigned int count);
+    Block compile(uint16_t pc, unsigned int limit);
+    void invalidate(unsigned int first, unsigned int last);
+    void note_store(uint16_t first, unsigned int count);
+    // Per profile, so interpreted instructions call the handlers directly
+    template <Quirks::Profile P>
+    uint64_t execute(uint64_t cycles); // Returns the idle cycles skipped
+    template <Quirks::Profile P>
+    void interpret();
+
+    Processor &cpu;
+    Quirks::Profile quirks; // Profile the current blocks were translated for
+    uint8_t *code{};
+    size_t codeUsed{};
+    Block blocks[MEM_SIZE_BYTES]{};      // Indexed by start address
+    uint8_t codeBytes[MEM_SIZE_BYTES]{}; // Set for bytes any block was built from
+
+    // Truncated copies of blocks, keyed by (start << 8) | instruction count
+    // and filed by the page their start is in, so a store only searches
+    // the pages it could reach
+    std::unordered_map<uint32_t, Block> partials[MEM_SIZE_BYTES >> PAGE_BITS];
+};
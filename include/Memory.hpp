@@ -0,0 +1,66 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Guest memory, sized by the quirk profile
+ *****************************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+// The classic machines address 4 KiB and XO-CHIP 64 KiB. Storage is
+// allocated for the size in use, so only XO-CHIP machines pay for 64 KiB;
+// it grows when a profile or a large ROM needs more and never shrinks.
+//
+// The range written since the last Clear is tracked, and every byte outside
+// it is zero. Copies, Clear and save states touch only that range, which
+// for most ROMs is a few KiB. Anything that stores into memory must report
+// it with NoteWritten.
+class Memory
+{
+  public:
+    static constexpr uint32_t CLASSIC_BYTES = 0x1000;
+    static constexpr uint32_t MAX_BYTES = 0x10000;
+
+    Memory() : Memory(CLASSIC_BYTES) {}
+    explicit Memory(uint32_t bytes);
+    Memory(const Memory &other);
+    Memory &operator=(const Memory &other);
+
+    uint8_t &operator[](uint32_t address) { return data[address]; }
+    uint8_t operator[](uint32_t address) const { return data[address]; }
+    uint8_t *Bytes() { return data.get(); }
+    const uint8_t *Bytes() const { return data.get(); }
+
+    // Addressable bytes, a power of two; callers wrap addresses with Mask()
+    uint32_t Size() const { return mask + 1; }
+    uint32_t Mask() const { return mask; }
+    void SetSize(uint32_t bytes);
+
+    // Bytes allocated, at least Size(). Reserve grows the storage without
+    // changing what is addressable, e.g. for a save state's written range.
+    uint32_t Capacity() const { return capacity; }
+    void Reserve(uint32_t bytes);
+
+    void NoteWritten(uint32_t first, uint32_t end)
+    {
+        written_first = std::min(written_first, first);
+        written_end = std::max(written_end, std::min(end, capacity));
+    }
+    uint32_t WrittenFirst() const { return written_first; }
+    uint32_t WrittenEnd() const { return written_end; }
+    bool Empty() const { return written_first >= written_end; }
+
+    // Zeroes everything written
+    void Clear();
+
+  private:
+    std::unique_ptr<uint8_t[]> data;
+    uint32_t capacity{};
+    uint32_t mask{};
+    uint32_t written_first{MAX_BYTES};
+    uint32_t written_end{};
+};
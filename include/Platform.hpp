@@ -5,26 +5,68 @@
  *
  * Description: Describes the required display functions
  *****************************************************************************/
+#pragma once
+
+#include "Audio.hpp"
+#include "FrameStats.hpp"
 #include <SDL2/SDL.h>
+#include <chrono>
 #include <cstdint>
 
 class Platform
 {
   public:
+    // With vsync requested, presenting blocks until the next vertical blank
     Platform(const char *title, int windowWidth, int windowHeight,
-             int textureWidth, int textureHeight);
+             int textureWidth, int textureHeight, bool vsync = false);
     ~Platform();
 
-    void Update(const void *buffer, int pitch);
+    // Uploads the rows set in dirtyRows (bit y for row y) and presents
+    void Update(const void *buffer, int pitch, uint64_t dirtyRows = ~0ull);
+    // Replaces the texture when the emulated resolution changes; it is
+    // stretched over the same window, so the next Update must upload every row
+    void SetTextureSize(int width, int height);
     bool ProcessInput(uint8_t *keys);
+    // Sleeps until an event arrives or timeoutMs passes, then drains the queue
+    bool WaitInput(uint8_t *keys, int timeoutMs);
+    // Ends a WaitInput early; unlike the rest of the class, safe from any thread
+    static void Wake();
+    bool TurboHeld() const { return turbo; } // Fast-forward key (Tab) is down
+    bool VsyncEnabled() const { return vsync; } // The renderer honoured the vsync request
+
+    // Opens the default audio device and plays `stream` from its callback,
+    // opening the stream at the rate and buffer size the device agreed to.
+    // The stream must outlive the Platform or a call to CloseAudio. Returns
+    // false, leaving the emulator silent, if there is no usable device.
+    bool OpenAudio(AudioStream &stream, AudioStream::Options options);
+    void CloseAudio();
+
+    // A key changed since the last present, which will be timed into InputLatency
+    bool InputPending() const { return inputPending; }
+    const FrameStats &InputLatency() const { return inputLatency; }
 
   private:
+    using Clock = std::chrono::steady_clock;
+
+    bool HandleEvent(const SDL_Event &event, uint8_t *keys);
+    static void AudioCallback(void *userdata, Uint8 *stream, int len);
+    void Present();
+
     SDL_Window *window{};
     SDL_Renderer *renderer{};
     SDL_Texture *texture{};
+    SDL_AudioDeviceID audioDevice{};
 
     int windowWidth{};
     int windowHeight{};
     int textureWidth{};
     int textureHeight{};
+
+    bool turbo{};
+    bool vsync{};
+
+    // Host arrival of the oldest key event not yet reflected on screen
+    bool inputPending{};
+    Clock::time_point inputArrival{};
+    FrameStats inputLatency;
 };
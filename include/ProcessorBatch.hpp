@@ -0,0 +1,110 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Many CHIP-8 machines stepped in lockstep, stored as
+ *              structure-of-arrays so one instruction runs across lanes
+ *****************************************************************************/
+#pragma once
+
+#include "chip8.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Runs `lanes` independent machines, all executing one instruction per step.
+// Every piece of per-machine state is stored as an array over lanes, so
+// lanes that sit at the same pc with the same opcode execute it together
+// with vector operations. Lanes that have diverged form further groups, and
+// stragglers run through a scalar copy of the handlers in opcodes.cpp. After
+// the same inputs, each lane is bit-identical to a Processor.
+//
+// Emulated time is shared: all lanes run at one instruction rate and their
+// timers tick together at the end of each 60 Hz frame.
+class ProcessorBatch
+{
+  public:
+    // Lanes are processed in blocks of this many; storage is padded to it
+    static const unsigned int LANE_BLOCK = 32;
+
+    explicit ProcessorBatch(unsigned int lanes);
+
+    unsigned int size() const { return lanes; }
+
+    // Loads the same program into every lane; returns 0 on success
+    int load_rom(const uint8_t *data, size_t size);
+    void set_instructions_per_second(double ips) { scheduler.SetInstructionsPerSecond(ips); }
+    // All lanes share one profile. The few quirk-dependent ops test it once
+    // per group rather than per lane.
+    void set_quirks(Quirks::Profile profile);
+    void set_key(unsigned int lane, unsigned int key, bool down)
+    {
+        keypad[(key & 0xFu) * stride + lane] = down;
+    }
+
+    // Lane l continues from seed + l, matching a Processor given
+    // seed_random(seed + l, engine). Until called, lanes draw from
+    // unrelated OS-seeded sequences.
+    void seed_random(uint64_t seed, Random::Engine engine = Random::Engine::XOSHIRO);
+
+    // Every lane executes exactly `cycles` instructions, as Processor::run
+    void run(uint64_t cycles);
+
+    // Copy one machine in or out. Loading takes the architectural state only;
+    // the instruction rate, frame position and quirks stay those of the batch.
+    void load_lane(unsigned int lane, const Processor &cpu);
+    void store_lane(unsigned int lane, Processor &cpu) const;
+    uint64_t state_hash(unsigned int lane) const;
+
+  private:
+    // Lanes are sorted into at most this many vector groups per step; any
+    // lane left over after that runs on its own
+    static const unsigned int MAX_GROUPS = 4;
+
+    // Row r of a [rows][stride] array
+    template <typename T>
+    T *row(std::vector<T> &v, unsigned int r) { return &v[r * stride]; }
+    template <typename T>
+    const T *row(const std::vector<T> &v, unsigned int r) const { return &v[r * stride]; }
+
+    unsigned int memory_rows() const { return static_cast<unsigned int>(memory.size() / stride); }
+    // Grows memory to the storage size covering `bytes`, as Memory::Reserve
+    void reserve_memory(unsigned int bytes);
+    void broadcast(const Processor &cpu);
+    void step();
+    unsigned int build_group(unsigned int leader);
+    void execute_group(const Instr &in);
+    void execute_lane(unsigned int lane, const Instr &in);
+    void tick_timers();
+
+    unsigned int lanes;
+    unsigned int stride; // Row pitch: lanes rounded up to a multiple of LANE_BLOCK
+
+    std::vector<uint8_t> registers;     // [N_REGISTERS][stride]
+    std::vector<uint8_t> memory;        // [memory_rows()][stride], sized by profile
+    std::vector<uint16_t> index;        // [stride]
+    std::vector<uint16_t> pc;           // [stride]
+    std::vector<uint16_t> stack;        // [STACK_SIZE][stride]
+    std::vector<uint8_t> stack_pointer; // [stride]
+    std::vector<uint8_t> delay_timer;   // [stride]
+    std::vector<uint8_t> sound_timer;   // [stride]
+    std::vector<uint8_t> keypad;        // [NUM_KEYS][stride]
+    std::vector<uint64_t> display;      // [DISPLAY_PLANES * HIRES_HEIGHT * ROW_WORDS][stride]
+    std::vector<uint32_t> generation;   // [stride]
+    std::vector<uint64_t> dirty_rows;   // [stride]
+    std::vector<Random> rng;            // [stride]
+    std::vector<uint8_t> hires;         // [stride]
+    std::vector<uint8_t> planes;        // [stride]
+    std::vector<uint8_t> flags;         // [N_REGISTERS][stride]
+    std::vector<uint8_t> audio_pattern; // [AUDIO_PATTERN_BYTES][stride]
+    std::vector<uint8_t> pitch;         // [stride]
+
+    Scheduler scheduler{700};
+    uint64_t frame_left{};
+    Quirks::Profile quirks{Quirks::Profile::MODERN};
+
+    // Per-step scratch, 0xFF for lanes still to run / in the current group
+    std::vector<uint8_t> pending;
+    std::vector<uint8_t> group;
+};
@@ -0,0 +1,69 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Optional per-opcode and per-PC execution counters
+ *****************************************************************************/
+#pragma once
+
+#include "chip8.hpp"
+
+// Build with `make PROFILE=1` (defines CHIP8_PROFILE) to count every executed
+// instruction by handler and by address, plus the cycles OP_Fx0a spends
+// spinning on a key. Without it the hooks below expand to nothing.
+//
+// Each thread counts into its own block so batch runs do not contend; the
+// report sums all of them. It is printed to stderr at exit, and on SIGUSR1 at
+// the next 60 Hz timer tick of any running instance.
+#ifdef CHIP8_PROFILE
+
+#include <atomic>
+#include <ostream>
+
+namespace Profiler
+{
+struct Counters
+{
+    std::atomic<uint64_t> ops[static_cast<size_t>(Op::COUNT)];
+    std::atomic<uint64_t> pcs[MEM_SIZE_BYTES];
+    std::atomic<uint64_t> keyWaits;
+};
+
+// This thread's counters, allocated and registered on first use
+Counters &Local();
+
+// Only the owning thread writes, so a plain load/store pair is enough and
+// keeps the increment free of locked instructions
+inline void Bump(std::atomic<uint64_t> &counter)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+inline void CountInstruction(Op op, uint16_t pc)
+{
+    Counters &c = Local();
+    Bump(c.ops[static_cast<size_t>(op)]);
+    Bump(c.pcs[pc & (MEM_SIZE_BYTES - 1)]);
+}
+
+inline void CountKeyWait()
+{
+    Bump(Local().keyWaits);
+}
+
+void Poll(); // Prints the report if one was requested by signal
+void Report(std::ostream &out);
+} // namespace Profiler
+
+#define CHIP8_PROFILE_INSTRUCTION(op, pc) Profiler::CountInstruction(op, pc)
+#define CHIP8_PROFILE_KEY_WAIT() Profiler::CountKeyWait()
+#define CHIP8_PROFILE_POLL() Profiler::Poll()
+
+#else
+
+#define CHIP8_PROFILE_INSTRUCTION(op, pc) ((void)0)
+#define CHIP8_PROFILE_KEY_WAIT() ((void)0)
+#define CHIP8_PROFILE_POLL() ((void)0)
+
+#endif
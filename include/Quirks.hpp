@@ -0,0 +1,66 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Behaviour differences between CHIP-8 interpreters of
+ *              different eras
+ *****************************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// ROMs were written against interpreters that disagree on a handful of
+// instructions. A profile fixes every one of those choices. The interpreter
+// is instantiated once per profile with the choices as constants, so the
+// handlers carry no compatibility branches; Processor::set_quirks selects
+// the instantiation at run time.
+namespace Quirks
+{
+enum class Profile : uint8_t
+{
+    MODERN, // This emulator's long-standing behaviour, the default
+    CHIP8,  // COSMAC VIP interpreter
+    SCHIP,  // SUPER-CHIP 1.1 on the HP 48
+    XOCHIP, // Octo's XO-CHIP
+    COUNT
+};
+
+struct Set
+{
+    bool shiftUsesVy;      // 8XY6/8XYE shift VY into VX instead of VX in place
+    bool memoryAdvancesI;  // FX55/FX65 leave I pointing past the last register
+    bool jumpUsesVx;       // BNNN adds VX (X = the top nibble of NNN), not V0
+    bool logicResetsVf;    // 8XY1/8XY2/8XY3 clear VF
+    bool spritesWrap;      // DXYN wraps pixels past an edge instead of clipping
+    bool bigLoresSprites;  // DXY0 draws 16x16 in low resolution too, not nothing
+    bool longSkips;        // Skips step over all four bytes of F000 NNNN
+    bool bigMemory;        // 64 KiB of memory rather than the original 4 KiB
+};
+
+constexpr Set SETS[] = {
+    //  shiftVy memoryI jumpVx resetVf wrap   big16  longSkip bigMem
+    {false, false, false, false, false, false, false, false}, // MODERN
+    {true, true, false, true, false, false, false, false},    // CHIP8
+    {false, false, true, false, false, true, false, false},   // SCHIP
+    {true, true, false, false, true, true, true, true},       // XOCHIP
+};
+static_assert(sizeof(SETS) / sizeof(SETS[0]) == static_cast<size_t>(Profile::COUNT),
+              "SETS must describe every Profile");
+
+constexpr const Set &Of(Profile profile) { return SETS[static_cast<size_t>(profile)]; }
+
+// Bytes of memory a profile addresses. Fetches wrap at this size, stores
+// and loads past it are dropped, and an FX1E that would carry I to it
+// leaves I unchanged.
+constexpr unsigned int MemoryBytes(const Set &set) { return set.bigMemory ? 0x10000u : 0x1000u; }
+
+// Guesses the profile a ROM was written for from the extended opcodes it
+// contains; a ROM using none of them gets MODERN
+Profile Detect(const uint8_t *rom, size_t size);
+
+// "modern", "chip8", "schip" or "xochip"; Parse returns false for anything else
+const char *Name(Profile profile);
+bool Parse(const char *name, Profile &profile);
+} // namespace Quirks
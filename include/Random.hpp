@@ -0,0 +1,120 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Small seedable random engines for the CXNN instruction
+ *****************************************************************************/
+#pragma once
+
+#include <cstdint>
+
+// Each machine owns one of these, so instances never share or contend on
+// generator state and a given seed always replays the same draws. Both
+// engines keep 128 bits of state in two words, which is all a save state
+// needs to capture.
+class Random
+{
+  public:
+    enum class Engine : uint8_t
+    {
+        XOSHIRO, // xoshiro128++
+        PCG,     // PCG32 (XSH-RR)
+    };
+
+    explicit Random(uint64_t seed = 0, Engine engine = Engine::XOSHIRO) { Seed(seed, engine); }
+
+    // Expands a 64-bit seed into full engine state with SplitMix64
+    void Seed(uint64_t seed, Engine engine)
+    {
+        this->engine = engine;
+        uint64_t a = splitMix(seed);
+        uint64_t b = splitMix(seed);
+
+        if (engine == Engine::PCG)
+        {
+            // Reference pcg32_srandom: odd increment, then fold in the seed
+            state[0] = 0;
+            state[1] = (b << 1u) | 1u;
+            pcgStep();
+            state[0] += a;
+            pcgStep();
+        }
+        else
+        {
+            state[0] = a;
+            state[1] = b;
+            if ((state[0] | state[1]) == 0)
+                state[0] = 1; // xoshiro's one forbidden state
+        }
+    }
+
+    // Seed derived from the operating system's entropy, for runs that
+    // should differ; distinct on every call
+    static uint64_t EntropySeed();
+    // Accepts "xoshiro" or "pcg"; returns false for anything else
+    static bool ParseEngine(const char *name, Engine &engine);
+
+    uint8_t NextByte()
+    {
+        // Both engines put their best bits at the top
+        return static_cast<uint8_t>((engine == Engine::PCG ? nextPcg() : nextXoshiro()) >> 24u);
+    }
+
+    // Raw state, for save states; Restore takes what State() returned
+    Engine GetEngine() const { return engine; }
+    uint64_t State(unsigned int word) const { return state[word & 1u]; }
+    void Restore(Engine engine, uint64_t word0, uint64_t word1)
+    {
+        this->engine = engine;
+        state[0] = word0;
+        state[1] = word1;
+    }
+
+  private:
+    static uint32_t rotl(uint32_t v, unsigned int k) { return (v << k) | (v >> (32u - k)); }
+
+    static uint64_t splitMix(uint64_t &x)
+    {
+        uint64_t z = (x += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30u)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27u)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31u);
+    }
+
+    // xoshiro128++: the four 32-bit words live in the halves of state[]
+    uint32_t nextXoshiro()
+    {
+        uint32_t s0 = static_cast<uint32_t>(state[0]);
+        uint32_t s1 = static_cast<uint32_t>(state[0] >> 32u);
+        uint32_t s2 = static_cast<uint32_t>(state[1]);
+        uint32_t s3 = static_cast<uint32_t>(state[1] >> 32u);
+
+        uint32_t result = rotl(s0 + s3, 7) + s0;
+        uint32_t t = s1 << 9u;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = rotl(s3, 11);
+
+        state[0] = s0 | (static_cast<uint64_t>(s1) << 32u);
+        state[1] = s2 | (static_cast<uint64_t>(s3) << 32u);
+        return result;
+    }
+
+    // PCG32: state[0] is the LCG state, state[1] the (odd) increment
+    void pcgStep() { state[0] = state[0] * 6364136223846793005ull + state[1]; }
+    uint32_t nextPcg()
+    {
+        uint64_t old = state[0];
+        pcgStep();
+        uint32_t xorshifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+        unsigned int rot = static_cast<unsigned int>(old >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((32u - rot) & 31u));
+    }
+
+    uint64_t state[2]{};
+    Engine engine{Engine::XOSHIRO};
+};
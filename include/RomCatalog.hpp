@@ -0,0 +1,82 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Memory-mapped ROM library identified by content hash
+ *****************************************************************************/
+#pragma once
+
+#include "Quirks.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Maps every ROM in a directory once and keeps what can be derived from a
+// ROM's bytes alone: its content hash, the quirk profile Quirks::Detect
+// picks, whether it fits in that profile's memory and a map of the bytes
+// reachable as code.
+// That derived data is cached in an index file next to the ROMs, keyed by
+// name, size and modification time, so reopening an unchanged library
+// neither hashes nor analyses anything and the ROM pages are only touched
+// when a machine loads them. The mappings are read-only and shared: any
+// number of machines load a ROM with Processor::load_rom(rom.data, rom.size),
+// a single copy into their memory.
+//
+// The index layout is documented in RomCatalog.cpp.
+class RomCatalog
+{
+  public:
+    struct Rom
+    {
+        std::string name;      // File name within the directory
+        uint64_t hash;         // FNV-1a of the image, as in SessionInfo::romHash
+        const uint8_t *data;   // The mapped image; valid while the catalog lives
+        size_t size;
+        bool fits;             // Small enough to load under the detected profile
+        Quirks::Profile quirks;
+        // Bit i set when an instruction reachable from START_ADDRESS starts
+        // at byte i of the image; empty for ROMs that do not fit
+        std::vector<uint8_t> code;
+
+        bool IsCode(size_t offset) const
+        {
+            return offset / 8 < code.size() && (code[offset / 8] >> (offset % 8)) & 1;
+        }
+    };
+
+    RomCatalog() = default;
+    ~RomCatalog() { Close(); }
+
+    RomCatalog(const RomCatalog &) = delete;
+    RomCatalog &operator=(const RomCatalog &) = delete;
+
+    // Maps every regular file in `directory` whose name does not start with
+    // a dot. The index defaults to <directory>/.chip8-catalog; failing to
+    // write it is reported but not an error. Returns 0 on success.
+    int Open(const std::string &directory, const std::string &indexPath = "");
+    void Close();
+
+    const std::vector<Rom> &Roms() const { return roms; }
+    // nullptr when no ROM has that content or name
+    const Rom *Find(uint64_t hash) const;
+    const Rom *FindName(const std::string &name) const;
+
+    // ROMs hashed and analysed by the last Open because the index had
+    // nothing current for them
+    size_t Analysed() const { return analysed; }
+
+  private:
+    struct Mapping
+    {
+        void *base;
+        size_t size;
+    };
+
+    std::vector<Rom> roms;
+    std::vector<Mapping> mappings;
+    std::unordered_map<uint64_t, size_t> byHash;
+    size_t analysed{};
+};
@@ -0,0 +1,62 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Splits an instruction rate into fixed 60 Hz timer ticks
+ *****************************************************************************/
+#pragma once
+
+#include <cstdint>
+
+// The delay and sound timers always count down at 60 Hz. The scheduler
+// hands out how many instructions belong to each tick for a given IPS
+// target, carrying the fractional part so that e.g. 500 IPS averages out
+// exactly, and turns elapsed wall-clock time into the number of ticks due.
+class Scheduler
+{
+  public:
+    static constexpr double TIMER_HZ = 60.0;
+    static constexpr double TICK_SECONDS = 1.0 / TIMER_HZ;
+
+    explicit Scheduler(double instructionsPerSecond, double fractionCarried = 0)
+        : ips(instructionsPerSecond), carry(fractionCarried) {}
+
+    double InstructionsPerSecond() const { return ips; }
+    double Carry() const { return carry; } // Fraction of an instruction owed to the next tick
+    void SetInstructionsPerSecond(double value) { ips = value; }
+
+    // Instruction budget for the next 60 Hz tick
+    uint64_t NextTickBudget()
+    {
+        carry += ips / TIMER_HZ;
+        uint64_t budget = static_cast<uint64_t>(carry);
+        carry -= static_cast<double>(budget);
+        return budget;
+    }
+
+    // Accumulates elapsed wall time and returns how many ticks are now due.
+    // Backlog is capped so a stall (e.g. a dragged window) does not make the
+    // emulator sprint to catch up afterwards.
+    unsigned int Advance(double seconds)
+    {
+        accumulator += seconds;
+        if (accumulator > MAX_BACKLOG_SECONDS)
+            accumulator = MAX_BACKLOG_SECONDS;
+
+        unsigned int ticks = 0;
+        while (accumulator >= TICK_SECONDS)
+        {
+            accumulator -= TICK_SECONDS;
+            ++ticks;
+        }
+        return ticks;
+    }
+
+  private:
+    static constexpr double MAX_BACKLOG_SECONDS = 0.25;
+
+    double ips;
+    double carry;
+    double accumulator{};
+};
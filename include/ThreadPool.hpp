@@ -0,0 +1,59 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Work-stealing thread pool used by the headless runners
+ *****************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+  public:
+    using Task = std::function<void()>;
+
+    // A thread count of 0 uses every hardware thread
+    explicit ThreadPool(unsigned int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void Submit(Task task);
+    void Wait(); // Block until every submitted task has finished
+    unsigned int Size() const { return static_cast<unsigned int>(workers.size()); }
+
+  private:
+    // Each worker owns a deque: the owner pops from the back, thieves take
+    // from the front so they grab the oldest (usually largest) work first.
+    struct Queue
+    {
+        std::mutex lock;
+        std::deque<Task> tasks;
+    };
+
+    void WorkerLoop(unsigned int id);
+    bool PopLocal(unsigned int id, Task &task);
+    bool Steal(unsigned int id, Task &task);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<size_t> pending{0};
+    std::atomic<unsigned int> nextQueue{0};
+    std::atomic<bool> stopping{false};
+
+    std::mutex sleepLock;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+};
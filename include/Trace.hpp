@@ -0,0 +1,124 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Binary execution trace written through a lock-free ring
+ *****************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+// One executed instruction, with the values it may have written, as
+// LoadTrace returns it
+struct TraceRecord
+{
+    uint64_t cycle;  // Processor::get_cycles() when the instruction started
+    uint16_t pc;
+    uint16_t opcode;
+    uint16_t index;  // I after the instruction
+    uint8_t vx;      // VX after the instruction
+    uint8_t vf;      // VF after the instruction
+};
+
+// What a traced machine reports besides its keyframes. Each event is
+// stamped with the instruction count it happened at.
+enum class TraceEvent : uint8_t
+{
+    KEYS = 1, // The keypad changed to the given bits, before the instruction
+    TICK,     // The timers ticked, before the instruction
+    SKIP,     // The given number of idle instructions were fast-forwarded
+    RUN,      // A run call returned; everything before the count executed
+    STEP,     // cycle() executed one instruction outside the count
+};
+
+// Attach to a Processor with set_tracer() and everything its interpreter
+// executes can be read back with LoadTrace. The interpreter is
+// deterministic, so the trace holds only what it cannot reproduce: a save
+// state whenever the machine is loaded, reset or reconfigured, and events
+// for keypad changes, timer ticks and fast-forwarded idle loops. LoadTrace
+// replays the instructions from those to rebuild every record, so the
+// emulating thread does no per-instruction work beyond keeping its count.
+//
+// Events are two 64-bit words in a preallocated single-producer/
+// single-consumer ring; a background thread drains the ring into the file
+// in large writes, so the emulating thread never formats text or makes a
+// system call. When the disk falls behind the producer waits for room
+// rather than dropping anything. The file layout is documented in
+// Trace.cpp; tools/trace.cpp decodes it.
+class TraceWriter
+{
+  public:
+    static const size_t DEFAULT_CAPACITY = size_t(1) << 19; // Words (4 MiB)
+
+    TraceWriter() = default;
+    ~TraceWriter() { Close(); }
+
+    TraceWriter(const TraceWriter &) = delete;
+    TraceWriter &operator=(const TraceWriter &) = delete;
+
+    // Capacity is rounded up to a power of two. Returns 0 on success.
+    int Open(const char *filename, size_t capacity = DEFAULT_CAPACITY);
+    bool IsOpen() const { return writer.joinable(); }
+    // Drains the ring and stops the writer thread; returns 0 if every
+    // event reached the file
+    int Close();
+
+    // Producer side: only the thread running the traced machine calls these
+    void Event(TraceEvent type, uint64_t cycle, uint64_t value = 0)
+    {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        if (h + 2 - cachedTail > ring.size())
+            wait(h, 2);
+        slots[h & mask] = static_cast<uint64_t>(type) << TYPE_SHIFT | cycle;
+        slots[(h + 1) & mask] = value;
+        head.store(h + 2, std::memory_order_release);
+    }
+    // Only changes are recorded
+    void Keys(uint64_t cycle, uint16_t keys)
+    {
+        if (keys != lastKeys)
+        {
+            lastKeys = keys;
+            Event(TraceEvent::KEYS, cycle, keys);
+        }
+    }
+    // The machine's whole state from Processor::save_state, and its keypad
+    void Keyframe(uint64_t cycle, const std::vector<uint8_t> &state, uint16_t keys);
+
+    // Times the ring was full and the producer had to wait for the disk
+    uint64_t Stalls() const { return stalls; }
+
+    // The top byte of an event's first word holds its type; 0 is a keyframe
+    static const unsigned int TYPE_SHIFT = 56;
+
+  private:
+    // Waits until `words` more fit behind the head
+    void wait(uint64_t h, size_t words);
+    void drain();
+
+    std::vector<uint64_t> ring;
+    uint64_t *slots{}; // ring.data(), kept apart for the producer's fast path
+    size_t mask{};
+    std::ofstream file;
+    std::thread writer;
+    bool failed{};
+
+    // Producer and consumer indices live on separate cache lines; the
+    // producer only rereads the consumer's when its cached copy says full
+    alignas(64) std::atomic<uint64_t> head{};
+    uint64_t cachedTail{};
+    uint64_t stalls{};
+    uint16_t lastKeys{};
+    alignas(64) std::atomic<uint64_t> tail{};
+    std::atomic<bool> stopping{};
+};
+
+// Reads a whole trace file back, replaying it into one record per executed
+// instruction; returns 0 on success
+int LoadTrace(const char *filename, std::vector<TraceRecord> &records);
@@ -0,0 +1,54 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Wait-free single-producer, single-consumer triple buffer
+ *****************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Hands the latest value from one thread to another without either side
+// ever blocking. The writer fills Back() and publishes it; the reader picks
+// up the most recent publication with Update() and reads Front(). Values
+// published while the reader is busy are overwritten, never queued.
+//
+// Three slots rotate: one owned by each side and one in the middle. Both
+// operations are a single atomic exchange on the middle slot's index, which
+// carries a flag telling the reader whether it holds something new.
+template <typename T>
+class TripleBuffer
+{
+  public:
+    // Writer side
+    T &Back() { return slots[back]; }
+    void Publish()
+    {
+        uint8_t old = middle.exchange(static_cast<uint8_t>(back | FRESH), std::memory_order_acq_rel);
+        back = old & INDEX;
+    }
+
+    // Reader side: returns false, keeping Front() as is, if nothing was
+    // published since the last call
+    bool Update()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH))
+            return false;
+
+        uint8_t old = middle.exchange(front, std::memory_order_acq_rel);
+        front = old & INDEX;
+        return true;
+    }
+    const T &Front() const { return slots[front]; }
+
+  private:
+    static constexpr uint8_t INDEX = 0x3;
+    static constexpr uint8_t FRESH = 0x4;
+
+    T slots[3]{};
+    uint8_t back{0};
+    uint8_t front{1};
+    std::atomic<uint8_t> middle{2};
+};
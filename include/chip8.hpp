@@ -5,22 +5,32 @@
  *
  * Description: Defines the CPU's core specifications and other useful functions
  *****************************************************************************/
+#pragma once
 
+#include "Display.hpp"
+#include "Memory.hpp"
+#include "Quirks.hpp"
+#include "Random.hpp"
+#include "Scheduler.hpp"
+#include "Trace.hpp"
+#include <cstddef>
 #include <cstdint>
+#include <algorithm>
 #include <cstring>
 #include <fstream>
 #include <iostream>
-#include <random>
+#include <vector>
 
 const unsigned int START_ADDRESS = 0x200;
-const int MEM_SIZE_BYTES = 4096;
+const int MEM_SIZE_BYTES = Memory::MAX_BYTES; // The largest address space, XO-CHIP's
 const unsigned int FONTSET_SIZE = 80;
 const unsigned int FONTSET_START_ADDRESS = 0x50;
-const unsigned int VIDEO_WIDTH = 64;
-const unsigned int VIDEO_HEIGHT = 32;
+const unsigned int BIG_FONTSET_SIZE = 160;
+const unsigned int BIG_FONTSET_START_ADDRESS = 0xA0;
 const unsigned int STACK_SIZE = 16;
 const unsigned int N_REGISTERS = 16;
 const unsigned int NUM_KEYS = 16;
+const unsigned int AUDIO_PATTERN_BYTES = 16;
 
 const uint8_t fontset[FONTSET_SIZE] = {
     0xF0, 0x90, 0x90, 0x90, 0xF0, // 0
@@ -41,100 +51,459 @@ const uint8_t fontset[FONTSET_SIZE] = {
     0xF0, 0x80, 0xF0, 0x80, 0x80  // F
 };
 
+// SUPER-CHIP's 8x10 digits, selected by FX30
+const uint8_t big_fontset[BIG_FONTSET_SIZE] = {
+    0x3C, 0x7E, 0xE7, 0xC3, 0xC3, 0xC3, 0xC3, 0xE7, 0x7E, 0x3C, // 0
+    0x18, 0x38, 0x58, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x3C, // 1
+    0x3E, 0x7F, 0xC3, 0x06, 0x0C, 0x18, 0x30, 0x60, 0xFF, 0xFF, // 2
+    0x3C, 0x7E, 0xC3, 0x03, 0x0E, 0x0E, 0x03, 0xC3, 0x7E, 0x3C, // 3
+    0x06, 0x0E, 0x1E, 0x36, 0x66, 0xC6, 0xFF, 0xFF, 0x06, 0x06, // 4
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFC, 0xFE, 0x03, 0xC3, 0x7E, 0x3C, // 5
+    0x3E, 0x7C, 0xC0, 0xC0, 0xFC, 0xFE, 0xC3, 0xC3, 0x7E, 0x3C, // 6
+    0xFF, 0xFF, 0x03, 0x06, 0x0C, 0x18, 0x30, 0x60, 0x60, 0x60, // 7
+    0x3C, 0x7E, 0xC3, 0xC3, 0x7E, 0x7E, 0xC3, 0xC3, 0x7E, 0x3C, // 8
+    0x3C, 0x7E, 0xC3, 0xC3, 0x7F, 0x3F, 0x03, 0x03, 0x3E, 0x7C, // 9
+    0x3C, 0x7E, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, // A
+    0xFC, 0xFE, 0xC3, 0xC3, 0xFE, 0xFE, 0xC3, 0xC3, 0xFE, 0xFC, // B
+    0x3C, 0x7E, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0x7E, 0x3C, // C
+    0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC, // D
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // E
+    0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0  // F
+};
+
+// Handler selected for an instruction by Processor::decode
+enum class Op : uint8_t
+{
+    OP_NULL,
+    OP_00E0, OP_00EE, OP_1nnn, OP_2nnn, OP_3xnn, OP_4xnn, OP_5xy0,
+    OP_6xnn, OP_7xnn, OP_8xy0, OP_8xy1, OP_8xy2, OP_8xy3, OP_8xy4,
+    OP_8xy5, OP_8xy6, OP_8xy7, OP_8xyE, OP_9xy0, OP_Annn, OP_Bnnn,
+    OP_Cxnn, OP_Dxyn, OP_Ex9e, OP_Exa1, OP_Fx07, OP_Fx0a, OP_Fx15,
+    OP_Fx18, OP_Fx1e, OP_Fx29, OP_Fx33, OP_Fx55, OP_Fx65,
+    // SUPER-CHIP
+    OP_00Cn, OP_00FB, OP_00FC, OP_00FD, OP_00FE, OP_00FF, OP_Fx30,
+    OP_Fx75, OP_Fx85,
+    // XO-CHIP
+    OP_00Dn, OP_5xy2, OP_5xy3, OP_F000, OP_Fx01, OP_F002, OP_Fx3a,
+    COUNT
+};
+
+// An instruction with all of its operand fields already extracted
+struct Instr
+{
+    Op op;
+    uint8_t x;    // Register index, bits 8-11
+    uint8_t y;    // Register index, bits 4-7
+    uint8_t n;    // Low nibble
+    uint8_t nn;   // Low byte
+    uint16_t nnn; // Low 12 bits
+};
+
+// Why a run*() call returned
+enum class Exit : uint8_t
+{
+    BUDGET,         // Executed the requested number of instructions
+    FRAME,          // Finished the current 60 Hz frame
+    DRAW,           // Executed an instruction that writes the display
+    KEY_WAIT,       // OP_Fx0a is blocked waiting for a key
+    INVALID_OPCODE, // Hit an instruction that decodes to OP_NULL
+    PREDICATE       // run_until's predicate returned true
+};
+
+// Events that end a run early, OR-ed together for run*()'s stop_on argument
+enum StopOn : unsigned int
+{
+    STOP_NONE = 0,
+    STOP_DRAW = 1u << 0,
+    STOP_KEY_WAIT = 1u << 1,
+    STOP_INVALID = 1u << 2,
+    STOP_FRAME = 1u << 3
+};
+
+struct RunResult
+{
+    Exit reason;
+    uint64_t cycles;         // Instructions executed by this call
+    uint64_t idle_cycles{};  // Part of `cycles` fast-forwarded through idle loops
+};
+
 class Processor
 {
+    // Hot state, read or written by nearly every instruction. It leads the
+    // object, ahead of the public members, so that it fills exactly one
+    // cache line; everything declared after it is touched far less often.
+    // The constructor asserts that it still does, ending at `executed`.
+    alignas(64) uint8_t registers[N_REGISTERS]{};
+    uint16_t pc{};
+    uint16_t index{};
+    uint8_t stack_pointer{};
+    uint8_t delay_timer{};
+    uint8_t sound_timer{};
+    bool hires{};
+    uint8_t planes{1};              // Bit-planes selected by FX01, bit p for plane p
+    unsigned int idle_countdown{1}; // See idle_skip
+    uint32_t side_effects{};        // Bumped by memory and flag stores, and random draws
+    uint32_t generation{};          // Bumped by every instruction that writes the display
+    uint64_t frame_left{};          // Emulated time: instructions left in the current 60 Hz frame
+    uint64_t dirty_rows{~0ull};     // Display rows changed since take_dirty_rows
+    uint64_t executed{};            // See get_cycles
+
   public:
     uint8_t keypad[NUM_KEYS]{};
-    uint32_t video[VIDEO_WIDTH * VIDEO_HEIGHT]{};
+    // Both bit-planes at high-resolution size; see Display.hpp for the layout
+    DisplayBits display{};
 
     // Initialization
-    Processor();
-    uint8_t randGen();
+    Processor(); // The random engine starts from an OS-derived seed
+    uint8_t randGen() { return rng.NextByte(); }
+    // Restarts CXNN's random sequence; equal seeds give equal draws
+    void seed_random(uint64_t seed, Random::Engine engine = Random::Engine::XOSHIRO)
+    {
+        rng.Seed(seed, engine);
+        trace_keyframe();
+    }
+    // Set the quirk profile first: a ROM must fit in the memory the
+    // profile addresses, so only XO-CHIP loads ROMs past 4 KiB
     int load_rom(char *filename);
-    void cycle();
+    int load_rom(const uint8_t *data, size_t size);
+    // Back to the power-on state without reconstructing: only the memory
+    // written since then is cleared, and nothing is allocated. The quirk
+    // profile, instruction rate, tracer and random generator are kept;
+    // seed_random makes the draws repeat. reload also loads a ROM.
+    void reset();
+    int reload(const uint8_t *data, size_t size)
+    {
+        reset();
+        return load_rom(data, size);
+    }
+    void cycle() { (this->*cycle_fn)(); } // Execute one instruction, without advancing the timers
+    void tick_timers(); // Count the delay and sound timers down; call at 60 Hz
+
+    // Batch execution in emulated time: every instruction uses up part of the
+    // current 60 Hz frame and the timers tick as each frame completes. When a
+    // stop event coincides with the end of a frame, FRAME is reported. Loops
+    // that can only spin until the next tick are fast-forwarded with no
+    // observable difference; RunResult::idle_cycles says how much was skipped.
+    void set_instructions_per_second(double ips) { scheduler.SetInstructionsPerSecond(ips); }
+    RunResult run(uint64_t budget, unsigned int stop_on = STOP_NONE)
+    {
+        return (this->*run_fn)(budget, stop_on, nullptr);
+    }
+    RunResult run_until_frame(unsigned int stop_on = STOP_NONE)
+    {
+        return run(UINT64_MAX, stop_on | STOP_FRAME);
+    }
+    // Runs until done(*this) is true before an instruction, or a stop event.
+    // The interpreter tests the predicate itself, between instructions, and
+    // does not fast-forward idle loops, so done sees every instruction
+    // boundary and get_cycles() counts one at a time.
+    template <typename Predicate>
+    RunResult run_until(Predicate done, uint64_t budget = UINT64_MAX,
+                        unsigned int stop_on = STOP_NONE);
+
+    // Save states: a self-contained, versioned little-endian snapshot whose
+    // layout is documented in savestate.cpp. Loaders return 0 on success.
+    std::vector<uint8_t> save_state() const;
+    int load_state(const uint8_t *data, size_t size);
+    int save_state(const char *filename) const;
+    int load_state(const char *filename);
+
+    // Independent copy of the whole machine for branching searches. Copying
+    // into an existing instance with fork_into avoids the allocation.
+    // Copies are never traced: a trace has exactly one producer.
+    Processor fork() const
+    {
+        Processor child = *this;
+        child.set_tracer(nullptr);
+        return child;
+    }
+    void fork_into(Processor &child) const
+    {
+        child = *this;
+        child.set_tracer(nullptr);
+    }
+
+    // Selects the interpreter built for a quirk profile (MODERN by default).
+    // Quirks::Detect suggests one for a ROM image.
+    void set_quirks(Quirks::Profile profile);
+    Quirks::Profile get_quirks() const { return quirks; }
+
+    // Traces everything the interpreter executes into `writer`, starting
+    // with a keyframe of the current state; null stops tracing. Untraced
+    // machines run an instantiation without the hooks, so tracing costs
+    // nothing until it is switched on. A Jit runs a traced machine entirely
+    // in the interpreter.
+    void set_tracer(TraceWriter *writer);
+    bool is_traced() const { return tracer != nullptr; }
+
+    // Read-only views of the CPU state, for tools and run_until predicates
+    uint16_t get_pc() const { return pc; }
+    uint16_t get_index() const { return index; }
+    uint8_t get_register(unsigned int i) const { return registers[i & 0xFu]; }
+    uint8_t get_delay_timer() const { return delay_timer; }
+    uint8_t get_sound_timer() const { return sound_timer; }
+    // Opcode at `address` as stored, wrapped to the profile's memory
+    uint16_t get_opcode(uint16_t address) const
+    {
+        return static_cast<uint16_t>((memory[address & memory.Mask()] << 8u) |
+                                     memory[(address + 1u) & memory.Mask()]);
+    }
+    // Instructions run() has executed since construction, fast-forwarded
+    // ones included; recorded input is stamped with it. cycle() steps
+    // outside emulated time and is not counted.
+    uint64_t get_cycles() const { return executed; }
+    uint64_t state_hash() const; // Hash of all architectural state, for diffing runs
+    // Current resolution: 64x32, or 128x64 after 00FF
+    bool is_hires() const { return hires; }
+    unsigned int display_width() const { return Display::Width(hires); }
+    unsigned int display_height() const { return Display::Height(hires); }
+    // Expand display to display_width() * display_height() pixels, coloured
+    // by which planes are lit; only rows set in `rows` are written. The
+    // static form converts a copy of display.
+    void render_rgba(uint32_t *out, uint64_t rows = ~0ull) const { render_rgba(display, hires, out, rows); }
+    static void render_rgba(const DisplayBits &display, bool hires, uint32_t *out, uint64_t rows = ~0ull);
+
+    // XO-CHIP audio: the 16-byte (128-sample) 1-bit pattern from F002 and
+    // the FX3A pitch, where 64 plays the pattern at 4000 samples/second
+    const uint8_t *get_audio_pattern() const { return audio_pattern; }
+    uint8_t get_pitch() const { return pitch; }
+
+    // Whether an instruction can change the display (STOP_DRAW's events)
+    static bool writes_display(Op op);
+
+    // Bumped by every instruction that writes the display
+    uint32_t display_generation() const { return generation; }
+    // Rows changed since the last call, bit y for row y. Scrolls and mode
+    // switches mark every row.
+    uint64_t take_dirty_rows()
+    {
+        uint64_t rows = dirty_rows;
+        dirty_rows = 0;
+        return rows;
+    }
+
+    static Instr decode(uint16_t opcode);
 
   private:
-    // Processor Data and Specifications
-    uint8_t registers[N_REGISTERS]{};
-    uint8_t memory[MEM_SIZE_BYTES]{};
-    uint16_t index{};
-    uint16_t pc{};
+    friend class Jit;
+    friend class ProcessorBatch;
+
+    // Cold state. Memory is sized by the quirk profile: 4 KiB, or 64 KiB
+    // for XO-CHIP.
+    Memory memory;
     uint16_t stack[STACK_SIZE]{};
-    uint8_t stack_pointer{};
-    uint8_t delay_timer{};
-    uint8_t sound_timer{};
-    uint16_t opcode;
+    Random rng;
 
-    // Opcodes
-    void OP_00E0(); // Clear the display by zeroing out the video buffer
-    void OP_00EE(); // Return a value
-    void OP_1nnn(); // Jump to address nnn by setting pc to that address
-    void OP_2nnn(); // Call subroutine at nnn
-    void OP_3xnn(); // Skip instruction if register Vx = nn
-    void OP_4xnn(); // Skip instruction if register Vx != nn
-    void OP_5xy0(); // Skip instruction if register Vx == register Vy
-    void OP_6xnn(); // Set register Vx = nn
-    void OP_7xnn(); // Add nn to register x
-    void OP_8xy0(); // Set register Vx to Vy;
-    void OP_8xy1(); // Bitwise OR on registers Vx and Vy; stored in Vx
-    void OP_8xy2(); // Bitwise AND on registers Vx and Vy; stored in Vx
-    void OP_8xy3(); // Bitwise XOR on registers Vx and Vy; stored in Vx
-    void OP_8xy4(); // Add two registers Vx and Vy store Vx, with a carry flag VF
-    void OP_8xy5(); // Subtract two registers Vx and Vy store Vx, with borrow VF
-    void OP_8xy6(); // Division by 2 and updating the flag
-    void OP_8xy7(); // Subtract with borrow, Vx and Vy, store in Vx
-    void OP_8xyE(); // Multiply Vx by 2
-    void OP_9xy0(); // Skip next instruction if register Vx != register Vy
-
-    void OP_Annn(); // Sets index to nnn
-    void OP_Bnnn(); // Jump to location nnn + V0
-    void OP_Cxnn(); // Set Vx = random byte AND kk
-    void OP_Dxyn(); // Draws a sprite at coordinate (VX, VY) that has a width of 8
-                    // pixels and a height of N pixels
-
-    void OP_Ex9e(); // Skip next instruction if key == Vx is pressed.
-    void OP_Exa1(); // Skip next instruction if key with the value of Vx is not
-                    // pressed.
-
-    void OP_Fx07(); // Set register Vx to delay timer.
-    void OP_Fx0a(); // Wait for keypress and set register Vx to that value.
-    void OP_Fx15(); // Set delay timer to register Vx.
-    void OP_Fx18(); // Set sound timer to register Vx.
-    void OP_Fx1e(); // Set index += register Vx.
-    void OP_Fx29(); // Store fontdata in index
-    void OP_Fx33(); // Store BCD representation of Vx in memory I, I+1 ...
-
-    void OP_Fx55(); // Store registers V0 to Vx in memory from index onwards
-    void OP_Fx65(); // Read registers V0 to Vx in memory from index onwards
-    void OP_NULL(); // Default, do nothing if instruction cannot be understood.
-
-    void Table0()
-    {
-        ((*this).*(table0[opcode & 0x000Fu]))();
-    }
+    // SUPER-CHIP / XO-CHIP state
+    uint8_t flags[N_REGISTERS]{};   // FX75/FX85 persistent flag registers
+    uint8_t audio_pattern[AUDIO_PATTERN_BYTES]{};
+    uint8_t pitch{64};
 
-    void Table8()
+    Scheduler scheduler{700};
+
+    void load_fonts();
+
+    void start_frame()
     {
-        ((*this).*(table8[opcode & 0x000Fu]))();
+        // A frame can be given zero instructions when the rate is below 60 IPS
+        while (frame_left == 0)
+        {
+            frame_left = scheduler.NextTickBudget();
+            if (frame_left == 0)
+                tick_timers();
+        }
     }
 
-    void TableE()
+    // Idle-loop detection. When execution branches back to a pc it reached
+    // earlier in the same frame and run call, with identical state and no
+    // draw, store or random draw in between, the loop is polling something
+    // that cannot change before the next timer tick or input. Whole further
+    // iterations are then skipped instead of executed.
+    struct IdleState
+    {
+        uint8_t registers[N_REGISTERS];
+        uint16_t stack[STACK_SIZE];
+        uint16_t index;
+        uint16_t pc;
+        uint8_t stack_pointer;
+        uint8_t delay_timer;
+        uint8_t sound_timer;
+        uint8_t unused; // Keeps the struct free of padding for memcmp
+        uint32_t generation;
+        uint32_t side_effects;
+    };
+    IdleState idle_probe{};
+    uint64_t idle_clock{};  // Caller's instruction count when the probe was taken
+    bool idle_armed{};
+    bool idle_matched{}; // The armed probe has matched at least once
+
+    // A probe is a snapshot at one backward branch compared at the next.
+    // Loops that turn out busy are probed exponentially less often, up to
+    // every IDLE_MAX_INTERVAL-th backward branch, so they stay cheap.
+    static constexpr unsigned int IDLE_MAX_INTERVAL = 64;
+    unsigned int idle_interval{1};
+
+    // Returns how many instructions (whole loop iterations, at most `room`)
+    // may be skipped; call after every backward branch
+    uint64_t idle_skip(uint64_t clock, uint64_t room)
     {
-        ((*this).*(tableE[opcode & 0x000Fu]))();
+        if (--idle_countdown != 0)
+            return 0;
+        return idle_probe_loop(clock, room);
     }
+    // Drops the probe at a timer tick or new input. A probe that never
+    // matched counts as a busy loop; after a match the next frame is probed
+    // straight away since the loop is likely still idling.
+    void idle_reset()
+    {
+        if (!idle_armed)
+            return;
+        idle_armed = false;
+        idle_interval = idle_matched ? 1 : std::min(idle_interval * 2, IDLE_MAX_INTERVAL);
+        idle_countdown = idle_interval;
+    }
+    uint64_t idle_probe_loop(uint64_t clock, uint64_t room);
+
+    // A run_until predicate, type-erased so the precompiled interpreter can
+    // call it: test(context, cpu) invokes the caller's callable
+    struct Until
+    {
+        bool (*test)(void *context, const Processor &cpu);
+        void *context;
+    };
+
+    // The interpreter, instantiated per quirk profile, with or without the
+    // trace hook and with or without a run_until predicate; run(),
+    // run_until() and cycle() call through to the instantiations set_quirks
+    // chose. Plain runs pass a null Until.
+    typedef RunResult (Processor::*RunFn)(uint64_t budget, unsigned int stop_on, const Until *until);
+    typedef void (Processor::*CycleFn)();
+    Quirks::Profile quirks{Quirks::Profile::MODERN};
+    uint32_t rom_end{}; // One past the loaded ROM; set_quirks warns if it no longer fits
+    RunFn run_fn{};
+    RunFn until_fn{};
+    CycleFn cycle_fn{};
+    TraceWriter *tracer{};
 
-    void TableF()
+    template <Quirks::Profile P, bool Traced, bool Predicated>
+    RunResult run_as(uint64_t budget, unsigned int stop_on, const Until *until);
+    template <Quirks::Profile P, bool Traced>
+    void cycle_as();
+    // While traced: the keyframe LoadTrace replays from after any change
+    // it could not reproduce
+    void trace_keyframe();
+    uint16_t keypad_bits() const;
+
+    // Fetches wrap at the end of memory so a stray pc can never index past it
+    Instr fetch() const { return decode(get_opcode(pc)); }
+    template <Quirks::Profile P>
+    void execute(const Instr &in);
+    // Stores of `count` bytes from I end any idle loop in progress
+    void note_store(unsigned int count)
     {
-        uint8_t index = opcode & 0x00FFu;
-        if (index > 0x65)
-            index = 0x00; // default to OP_NULL
-        ((*this).*(tableF[index]))();
+        ++side_effects;
+        memory.NoteWritten(index, index + count);
     }
 
-    typedef void (Processor::*ProcessorFunc)();
-    ProcessorFunc table[0xF + 1];
-    ProcessorFunc table0[0xE + 1];
-    ProcessorFunc table8[0xE + 1];
-    ProcessorFunc tableE[0xE + 1];
-    ProcessorFunc tableF[0x65 + 1];
+    // Opcodes
+    void OP_00E0(const Instr &in); // Clear the display by zeroing out the display rows
+    void OP_00EE(const Instr &in); // Return a value
+    void OP_1nnn(const Instr &in); // Jump to address nnn by setting pc to that address
+    void OP_2nnn(const Instr &in); // Call subroutine at nnn
+    template <Quirks::Profile P>
+    void OP_3xnn(const Instr &in); // Skip instruction if register Vx = nn
+    template <Quirks::Profile P>
+    void OP_4xnn(const Instr &in); // Skip instruction if register Vx != nn
+    template <Quirks::Profile P>
+    void OP_5xy0(const Instr &in); // Skip instruction if register Vx == register Vy
+    void OP_6xnn(const Instr &in); // Set register Vx = nn
+    void OP_7xnn(const Instr &in); // Add nn to register x
+    void OP_8xy0(const Instr &in); // Set register Vx to Vy;
+    template <Quirks::Profile P>
+    void OP_8xy1(const Instr &in); // Bitwise OR on registers Vx and Vy; stored in Vx
+    template <Quirks::Profile P>
+    void OP_8xy2(const Instr &in); // Bitwise AND on registers Vx and Vy; stored in Vx
+    template <Quirks::Profile P>
+    void OP_8xy3(const Instr &in); // Bitwise XOR on registers Vx and Vy; stored in Vx
+    void OP_8xy4(const Instr &in); // Add two registers Vx and Vy store Vx, with a carry flag VF
+    void OP_8xy5(const Instr &in); // Subtract two registers Vx and Vy store Vx, with borrow VF
+    template <Quirks::Profile P>
+    void OP_8xy6(const Instr &in); // Division by 2 and updating the flag
+    void OP_8xy7(const Instr &in); // Subtract with borrow, Vx and Vy, store in Vx
+    template <Quirks::Profile P>
+    void OP_8xyE(const Instr &in); // Multiply Vx by 2
+    template <Quirks::Profile P>
+    void OP_9xy0(const Instr &in); // Skip next instruction if register Vx != register Vy
+
+    void OP_Annn(const Instr &in); // Sets index to nnn
+    template <Quirks::Profile P>
+    void OP_Bnnn(const Instr &in); // Jump to location nnn + V0
+    void OP_Cxnn(const Instr &in); // Set Vx = random byte AND kk
+    template <Quirks::Profile P>
+    void OP_Dxyn(const Instr &in); // Draws a sprite at coordinate (VX, VY) that has a width of 8
+                                   // pixels and a height of N pixels, XORed a row at a time
+
+    template <Quirks::Profile P>
+    void OP_Ex9e(const Instr &in); // Skip next instruction if key == Vx is pressed.
+    template <Quirks::Profile P>
+    void OP_Exa1(const Instr &in); // Skip next instruction if key with the value of Vx is not
+                                   // pressed.
+
+    void OP_Fx07(const Instr &in); // Set register Vx to delay timer.
+    void OP_Fx0a(const Instr &in); // Wait for keypress and set register Vx to that value.
+    void OP_Fx15(const Instr &in); // Set delay timer to register Vx.
+    void OP_Fx18(const Instr &in); // Set sound timer to register Vx.
+    template <Quirks::Profile P>
+    void OP_Fx1e(const Instr &in); // Set index += register Vx.
+    void OP_Fx29(const Instr &in); // Store fontdata in index
+    void OP_Fx33(const Instr &in); // Store BCD representation of Vx in memory I, I+1 ...
+
+    template <Quirks::Profile P>
+    void OP_Fx55(const Instr &in); // Store registers V0 to Vx in memory from index onwards
+    template <Quirks::Profile P>
+    void OP_Fx65(const Instr &in); // Read registers V0 to Vx in memory from index onwards
+    void OP_NULL(const Instr &in); // Default, do nothing if instruction cannot be understood.
+
+    // SUPER-CHIP
+    void OP_00Cn(const Instr &in); // Scroll the selected planes down n rows
+    void OP_00FB(const Instr &in); // Scroll the selected planes right 4 pixels
+    void OP_00FC(const Instr &in); // Scroll the selected planes left 4 pixels
+    void OP_00FD(const Instr &in); // Exit the interpreter: park on this instruction
+    void OP_00FE(const Instr &in); // Switch to low resolution and clear the display
+    void OP_00FF(const Instr &in); // Switch to high resolution and clear the display
+    void OP_Fx30(const Instr &in); // Point index at the big font digit for Vx
+    void OP_Fx75(const Instr &in); // Save V0 to Vx in the flag registers
+    void OP_Fx85(const Instr &in); // Restore V0 to Vx from the flag registers
+
+    // XO-CHIP
+    void OP_00Dn(const Instr &in); // Scroll the selected planes up n rows
+    void OP_5xy2(const Instr &in); // Store Vx to Vy (either order) at index, leaving index alone
+    void OP_5xy3(const Instr &in); // Load Vx to Vy (either order) from index, leaving index alone
+    void OP_F000(const Instr &in); // Load index from the 16-bit word that follows
+    void OP_Fx01(const Instr &in); // Select the bit-planes later draws, clears and scrolls use
+    void OP_F002(const Instr &in); // Load the 16-byte audio pattern from index
+    void OP_Fx3a(const Instr &in); // Set the audio pitch to Vx
+
+    // Steps over the next instruction; with XO-CHIP's long skips that is
+    // four bytes when it is F000 NNNN
+    template <Quirks::Profile P>
+    void skip_next();
+    // Display::Draw and friends reach the display through this
+    auto display_word()
+    {
+        return [this](unsigned int p, unsigned int y, unsigned int w) -> uint64_t & { return display[p][y][w]; };
+    }
+    void mark_display_changed()
+    {
+        dirty_rows = ~0ull;
+        ++generation;
+    }
 };
+
+template <typename Predicate>
+RunResult Processor::run_until(Predicate done, uint64_t budget, unsigned int stop_on)
+{
+    Until until{[](void *context, const Processor &cpu) { return static_cast<bool>((*static_cast<Predicate *>(context))(cpu)); },
+                &done};
+    return (this->*until_fn)(budget, stop_on, &until);
+}
@@ -0,0 +1,287 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Synthesizes the buzzer and feeds it to a device or WAV file
+ *
+ * XO-CHIP audio: the 128-bit pattern loaded by F002 is played MSB first,
+ * looping, at 4000 * 2^((pitch - 64) / 48) bits per second. Samples are
+ * +amplitude for a set bit and -amplitude for a clear one. Without a
+ * pattern the buzzer is a 440 Hz square wave.
+ *
+ * WAV layout: the canonical 44-byte RIFF header (PCM, 1 channel, 16 bits)
+ * followed by little-endian samples. The RIFF and data sizes are written as
+ * zero when the file is opened and filled in by Close.
+ *****************************************************************************/
+
+#include "Audio.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+constexpr unsigned int FRAMES_PER_SECOND = 60;
+constexpr unsigned int PATTERN_BITS = AUDIO_PATTERN_BYTES * 8;
+constexpr size_t WAV_HEADER_BYTES = 44;
+
+int16_t amplitudeOf(double volume)
+{
+    return static_cast<int16_t>(std::clamp(volume, 0.0, 1.0) * 32767.0);
+}
+
+void put(uint8_t *&p, uint32_t v, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+        *p++ = static_cast<uint8_t>(v >> (8 * i));
+}
+
+void putTag(uint8_t *&p, const char *tag)
+{
+    std::memcpy(p, tag, 4);
+    p += 4;
+}
+
+// The header for `samples` samples already written
+void wavHeader(uint8_t (&header)[WAV_HEADER_BYTES], int sampleRate, uint64_t samples)
+{
+    uint32_t data = static_cast<uint32_t>(std::min<uint64_t>(samples * 2, 0xFFFFFFFFu - 36));
+    uint8_t *p = header;
+    putTag(p, "RIFF");
+    put(p, 36 + data, 4);
+    putTag(p, "WAVE");
+    putTag(p, "fmt ");
+    put(p, 16, 4);                                    // fmt chunk size
+    put(p, 1, 2);                                     // PCM
+    put(p, 1, 2);                                     // Channels
+    put(p, static_cast<uint32_t>(sampleRate), 4);
+    put(p, static_cast<uint32_t>(sampleRate) * 2, 4); // Bytes per second
+    put(p, 2, 2);                                     // Bytes per sample frame
+    put(p, 16, 2);                                    // Bits per sample
+    putTag(p, "data");
+    put(p, data, 4);
+}
+} // namespace
+
+AudioFrame AudioFrame::Capture(const Processor &cpu)
+{
+    AudioFrame frame;
+    frame.soundTimer = cpu.get_sound_timer();
+    frame.pitch = cpu.get_pitch();
+    std::memcpy(frame.pattern, cpu.get_audio_pattern(), sizeof(frame.pattern));
+    frame.patterned = std::any_of(frame.pattern, frame.pattern + AUDIO_PATTERN_BYTES,
+                                  [](uint8_t b) { return b != 0; });
+    return frame;
+}
+
+AudioSynth::AudioSynth(int sampleRate, double volume)
+    : sampleRate(sampleRate), amplitude(amplitudeOf(volume))
+{
+}
+
+void AudioSynth::Set(const AudioFrame &frame)
+{
+    if (frame.soundTimer == 0)
+    {
+        Silence();
+        return;
+    }
+
+    // Restart the waveform only when it changes, so held tones stay smooth
+    bool changed = !sounding || frame.patterned != patterned ||
+                   (patterned && std::memcmp(pattern, frame.pattern, sizeof(pattern)) != 0);
+    if (changed)
+        phase = 0;
+
+    sounding = true;
+    patterned = frame.patterned;
+    if (patterned)
+    {
+        std::memcpy(pattern, frame.pattern, sizeof(pattern));
+        step = 4000.0 * std::exp2((frame.pitch - 64) / 48.0) / sampleRate;
+    }
+    else
+    {
+        step = BEEP_HZ / sampleRate;
+    }
+}
+
+void AudioSynth::Silence()
+{
+    sounding = false;
+}
+
+size_t AudioSynth::FrameSamples()
+{
+    remainder += static_cast<unsigned int>(sampleRate);
+    size_t samples = remainder / FRAMES_PER_SECOND;
+    remainder %= FRAMES_PER_SECOND;
+    return samples;
+}
+
+void AudioSynth::Render(int16_t *out, size_t count)
+{
+    if (!sounding)
+    {
+        std::fill_n(out, count, static_cast<int16_t>(0));
+        return;
+    }
+
+    const int16_t high = amplitude;
+    const int16_t low = static_cast<int16_t>(-amplitude);
+    if (patterned)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            unsigned int bit = static_cast<unsigned int>(phase);
+            out[i] = (pattern[bit / 8] >> (7 - bit % 8)) & 1 ? high : low;
+            phase += step;
+            if (phase >= PATTERN_BITS)
+                phase -= PATTERN_BITS;
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = phase < 0.5 ? high : low;
+            phase += step;
+            if (phase >= 1.0)
+                phase -= 1.0;
+        }
+    }
+}
+
+void AudioStream::Open(const Options &options)
+{
+    this->options = options;
+    this->options.leadFrames = std::max(1u, options.leadFrames);
+    size_t capacity = 1;
+    while (capacity < std::max<size_t>(options.capacity, this->options.leadFrames * 2))
+        capacity <<= 1;
+    ring.assign(capacity, AudioFrame{});
+    mask = capacity - 1;
+    synth = AudioSynth(options.sampleRate, options.volume);
+    remaining = 0;
+    priming = true;
+    held = false;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+}
+
+void AudioStream::Push(const Processor &cpu)
+{
+    uint64_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= ring.size())
+    {
+        ++dropped;
+        return;
+    }
+    ring[h & mask] = AudioFrame::Capture(cpu);
+    head.store(h + 1, std::memory_order_release);
+}
+
+// Starts the next frame length of output: the oldest queued frame, the
+// current one held over a gap, or silence
+void AudioStream::next()
+{
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    uint64_t queued = head.load(std::memory_order_acquire) - t;
+    remaining = synth.FrameSamples();
+
+    if (queued == 0)
+    {
+        if (!priming && !held)
+        {
+            underruns.fetch_add(1, std::memory_order_relaxed);
+            held = true;
+            return;
+        }
+        priming = true;
+        synth.Silence();
+        return;
+    }
+    if (priming && queued < options.leadFrames)
+    {
+        synth.Silence();
+        return;
+    }
+
+    // Do not let a backlog turn into latency
+    if (queued > options.leadFrames + 1)
+        t += queued - options.leadFrames;
+    synth.Set(ring[t & mask]);
+    tail.store(t + 1, std::memory_order_release);
+    priming = false;
+    held = false;
+}
+
+void AudioStream::Render(int16_t *out, size_t count)
+{
+    while (count > 0)
+    {
+        if (remaining == 0)
+            next();
+        size_t n = std::min(remaining, count);
+        synth.Render(out, n);
+        out += n;
+        count -= n;
+        remaining -= n;
+    }
+}
+
+int WavWriter::Open(const char *filename, int sampleRate, double volume)
+{
+    Close();
+    out = std::fopen(filename, "wb");
+    if (!out)
+    {
+        std::cerr << "Failed to open audio output: " << filename << "\n";
+        return 1;
+    }
+
+    synth = AudioSynth(sampleRate, volume);
+    size_t most = (static_cast<size_t>(sampleRate) + FRAMES_PER_SECOND - 1) / FRAMES_PER_SECOND;
+    samples.resize(most);
+    bytes.resize(most * 2);
+    written = 0;
+    failed = false;
+
+    uint8_t header[WAV_HEADER_BYTES];
+    wavHeader(header, sampleRate, 0);
+    failed = std::fwrite(header, 1, sizeof(header), out) != sizeof(header);
+    return 0;
+}
+
+void WavWriter::Write(const Processor &cpu)
+{
+    if (!out)
+        return;
+
+    synth.Set(AudioFrame::Capture(cpu));
+    size_t n = synth.FrameSamples();
+    synth.Render(samples.data(), n);
+    uint8_t *p = bytes.data();
+    for (size_t i = 0; i < n; ++i)
+        put(p, static_cast<uint16_t>(samples[i]), 2);
+    failed |= std::fwrite(bytes.data(), 1, n * 2, out) != n * 2;
+    written += n;
+}
+
+int WavWriter::Close()
+{
+    if (!out)
+        return 0;
+
+    uint8_t header[WAV_HEADER_BYTES];
+    wavHeader(header, synth.SampleRate(), written);
+    failed |= std::fseek(out, 0, SEEK_SET) != 0;
+    failed |= std::fwrite(header, 1, sizeof(header), out) != sizeof(header);
+    failed |= std::fclose(out) != 0;
+    out = nullptr;
+    if (failed)
+        std::cerr << "Failed to write audio output\n";
+    return failed ? 1 : 0;
+}
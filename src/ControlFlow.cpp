@@ -0,0 +1,341 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Finds the basic blocks, sprites and stores of a ROM image
+ *****************************************************************************/
+
+#include "ControlFlow.hpp"
+#include <algorithm>
+
+namespace
+{
+using ControlFlow::Byte;
+using ControlFlow::Terminator;
+
+class Image
+{
+  public:
+    Image(const uint8_t *rom, size_t size) : rom(rom), size(size) {}
+
+    bool Contains(uint32_t address) const
+    {
+        return address >= START_ADDRESS && address - START_ADDRESS < size;
+    }
+    // -1 unless both bytes of the word are in the image
+    int Word(uint32_t address) const
+    {
+        if (!Contains(address) || !Contains(address + 1))
+            return -1;
+        size_t offset = address - START_ADDRESS;
+        return (rom[offset] << 8) | rom[offset + 1];
+    }
+
+  private:
+    const uint8_t *rom;
+    size_t size;
+};
+
+unsigned int lengthOf(Op op)
+{
+    return op == Op::OP_F000 ? 4 : 2;
+}
+
+bool isSkip(Op op)
+{
+    return op == Op::OP_3xnn || op == Op::OP_4xnn || op == Op::OP_5xy0 || op == Op::OP_9xy0 ||
+           op == Op::OP_Ex9e || op == Op::OP_Exa1;
+}
+
+// Whether `op` ends a block, and if so how and where control may go next
+bool terminates(const Image &image, uint32_t address, const Instr &in, ControlFlow::Block &block)
+{
+    block.successors.clear();
+    block.target = 0;
+    switch (in.op)
+    {
+    case Op::OP_1nnn:
+        block.terminator = Terminator::JUMP;
+        block.target = in.nnn;
+        block.successors.push_back(in.nnn);
+        return true;
+    case Op::OP_2nnn:
+        block.terminator = Terminator::CALL;
+        block.target = in.nnn;
+        block.successors.push_back(static_cast<uint16_t>(address + 2));
+        return true;
+    case Op::OP_00EE:
+        block.terminator = Terminator::RETURN;
+        return true;
+    case Op::OP_Bnnn:
+        block.terminator = Terminator::INDIRECT;
+        block.target = in.nnn;
+        return true;
+    case Op::OP_00FD:
+    case Op::OP_NULL:
+        block.terminator = Terminator::HALT;
+        return true;
+    default:
+        break;
+    }
+    if (!isSkip(in.op))
+        return false;
+
+    // Under XO-CHIP a skip steps over all of F000 NNNN
+    block.terminator = Terminator::SKIP;
+    block.successors.push_back(static_cast<uint16_t>(address + 2));
+    block.successors.push_back(static_cast<uint16_t>(address + 4));
+    if (image.Word(address + 2) == 0xF000)
+        block.successors.push_back(static_cast<uint16_t>(address + 6));
+    return true;
+}
+
+// What is known about the machine part-way through a block
+struct Constants
+{
+    bool known[N_REGISTERS]{};
+    uint8_t value[N_REGISTERS]{};
+    bool indexKnown{};
+    uint32_t index{};
+
+    void Forget(unsigned int first, unsigned int last)
+    {
+        for (unsigned int r = std::min(first, last); r <= std::max(first, last); ++r)
+            known[r] = false;
+    }
+};
+
+void mark(ControlFlow::Graph &graph, uint32_t first, uint32_t count, Byte kind)
+{
+    for (uint32_t a = first; a < first + count; ++a)
+    {
+        uint32_t offset = a - START_ADDRESS;
+        if (a < START_ADDRESS || offset >= graph.bytes.size())
+            continue;
+        // Instructions always win; a sprite outranks a plain data reference
+        Byte &b = graph.bytes[offset];
+        if (b == Byte::UNKNOWN || (b == Byte::DATA && kind == Byte::SPRITE))
+            b = kind;
+    }
+}
+
+void store(ControlFlow::Graph &graph, uint16_t pc, Op op, const Constants &c, uint32_t count)
+{
+    ControlFlow::Store s{pc, op, c.indexKnown, 0, 0, false};
+    if (c.indexKnown)
+    {
+        s.first = static_cast<uint16_t>(c.index);
+        s.last = static_cast<uint16_t>(std::min<uint32_t>(c.index + count - 1, MEM_SIZE_BYTES - 1));
+        for (uint32_t a = s.first; a <= s.last; ++a)
+        {
+            Byte b = graph.At(a);
+            s.hitsCode |= b == Byte::CODE || b == Byte::OPERAND;
+        }
+        mark(graph, c.index, count, Byte::DATA);
+    }
+    graph.stores.push_back(s);
+}
+
+// Replays a block with constant registers and I to find what it reads,
+// draws and writes through I
+void followIndex(ControlFlow::Graph &graph, const Image &image, const ControlFlow::Block &block)
+{
+    Constants c;
+    for (uint32_t address = block.start; address < block.end;)
+    {
+        int word = image.Word(address);
+        if (word < 0)
+            break;
+        Instr in = Processor::decode(static_cast<uint16_t>(word));
+        const unsigned int x = in.x;
+        const unsigned int y = in.y;
+        const uint16_t pc = static_cast<uint16_t>(address);
+
+        switch (in.op)
+        {
+        case Op::OP_6xnn:
+            c.known[x] = true;
+            c.value[x] = in.nn;
+            break;
+        case Op::OP_7xnn:
+            c.value[x] = static_cast<uint8_t>(c.value[x] + in.nn);
+            break;
+        case Op::OP_8xy0:
+            c.known[x] = c.known[y];
+            c.value[x] = c.value[y];
+            break;
+        case Op::OP_8xy1: case Op::OP_8xy2: case Op::OP_8xy3: case Op::OP_8xy4:
+        case Op::OP_8xy5: case Op::OP_8xy6: case Op::OP_8xy7: case Op::OP_8xyE:
+            c.known[x] = false;
+            c.known[0xF] = false;
+            break;
+        case Op::OP_Cxnn: case Op::OP_Fx07: case Op::OP_Fx0a:
+            c.known[x] = false;
+            break;
+        case Op::OP_Fx85:
+            c.Forget(0, x);
+            break;
+        case Op::OP_Annn:
+            c.indexKnown = true;
+            c.index = in.nnn;
+            break;
+        case Op::OP_F000:
+            c.indexKnown = image.Word(address + 2) >= 0;
+            c.index = static_cast<uint32_t>(image.Word(address + 2));
+            break;
+        case Op::OP_Fx1e:
+            c.indexKnown = c.indexKnown && c.known[x];
+            c.index = (c.index + c.value[x]) & 0xFFFFu;
+            break;
+        case Op::OP_Fx29: case Op::OP_Fx30:
+            // The built-in font lives below the image
+            c.indexKnown = false;
+            break;
+        case Op::OP_Dxyn:
+            if (c.indexKnown)
+                mark(graph, c.index, in.n ? in.n : 32, Byte::SPRITE);
+            break;
+        case Op::OP_Fx65:
+            if (c.indexKnown)
+                mark(graph, c.index, x + 1, Byte::DATA);
+            c.Forget(0, x);
+            // Some profiles move I past the registers
+            c.indexKnown = false;
+            break;
+        case Op::OP_5xy3:
+            if (c.indexKnown)
+                mark(graph, c.index, (x > y ? x - y : y - x) + 1, Byte::DATA);
+            c.Forget(x, y);
+            break;
+        case Op::OP_F002:
+            if (c.indexKnown)
+                mark(graph, c.index, AUDIO_PATTERN_BYTES, Byte::DATA);
+            break;
+        case Op::OP_Fx33:
+            store(graph, pc, in.op, c, 3);
+            break;
+        case Op::OP_Fx55:
+            store(graph, pc, in.op, c, x + 1);
+            c.indexKnown = false;
+            break;
+        case Op::OP_5xy2:
+            store(graph, pc, in.op, c, (x > y ? x - y : y - x) + 1);
+            break;
+        default:
+            break;
+        }
+        address += lengthOf(in.op);
+    }
+}
+} // namespace
+
+const ControlFlow::Block *ControlFlow::Graph::BlockAt(uint16_t address) const
+{
+    auto it = std::lower_bound(blocks.begin(), blocks.end(), address,
+                               [](const Block &b, uint16_t a) { return b.start < a; });
+    return it != blocks.end() && it->start == address ? &*it : nullptr;
+}
+
+size_t ControlFlow::Graph::SuspectStores() const
+{
+    size_t n = 0;
+    for (const Store &s : stores)
+        n += !s.known || s.hitsCode;
+    return n;
+}
+
+ControlFlow::Graph ControlFlow::Analyse(const uint8_t *rom, size_t size)
+{
+    size = std::min<size_t>(size, MEM_SIZE_BYTES - START_ADDRESS);
+    const Image image(rom, size);
+    Graph graph;
+    graph.bytes.assign(size, Byte::UNKNOWN);
+    std::vector<uint8_t> leader(size);
+
+    // Pass 1: every reachable instruction, and where blocks must begin
+    Block scratch;
+    std::vector<uint32_t> pending{START_ADDRESS};
+    if (image.Contains(START_ADDRESS))
+        leader[0] = 1;
+    while (!pending.empty())
+    {
+        uint32_t address = pending.back();
+        pending.pop_back();
+
+        int word = image.Word(address);
+        if (word < 0 || graph.bytes[address - START_ADDRESS] == Byte::CODE)
+            continue;
+        Instr in = Processor::decode(static_cast<uint16_t>(word));
+        unsigned int length = lengthOf(in.op);
+        graph.bytes[address - START_ADDRESS] = Byte::CODE;
+        for (unsigned int i = 1; i < length && image.Contains(address + i); ++i)
+        {
+            if (graph.bytes[address + i - START_ADDRESS] != Byte::CODE)
+                graph.bytes[address + i - START_ADDRESS] = Byte::OPERAND;
+        }
+
+        if (!terminates(image, address, in, scratch))
+        {
+            pending.push_back(address + length);
+            continue;
+        }
+        if (scratch.terminator == Terminator::CALL)
+        {
+            graph.subroutines.push_back(scratch.target);
+            scratch.successors.push_back(scratch.target);
+        }
+        for (uint16_t next : scratch.successors)
+        {
+            pending.push_back(next);
+            if (image.Contains(next))
+                leader[next - START_ADDRESS] = 1;
+        }
+    }
+
+    std::sort(graph.subroutines.begin(), graph.subroutines.end());
+    graph.subroutines.erase(std::unique(graph.subroutines.begin(), graph.subroutines.end()),
+                            graph.subroutines.end());
+
+    // Pass 2: cut the instructions into blocks at leaders and terminators
+    for (size_t offset = 0; offset < size; ++offset)
+    {
+        if (!leader[offset] || graph.bytes[offset] != Byte::CODE)
+            continue;
+
+        Block block;
+        block.start = static_cast<uint16_t>(START_ADDRESS + offset);
+        uint32_t address = block.start;
+        for (;;)
+        {
+            Instr in = Processor::decode(static_cast<uint16_t>(image.Word(address)));
+            uint32_t next = address + lengthOf(in.op);
+            block.last = static_cast<uint16_t>(address);
+            if (terminates(image, address, in, block))
+            {
+                block.end = static_cast<uint16_t>(std::min<uint32_t>(next, MEM_SIZE_BYTES - 1));
+                break;
+            }
+            if (image.Word(next) < 0)
+            {
+                block.terminator = Terminator::END;
+                block.end = static_cast<uint16_t>(std::min<uint32_t>(next, MEM_SIZE_BYTES - 1));
+                break;
+            }
+            if (leader[next - START_ADDRESS])
+            {
+                block.terminator = Terminator::FALLTHROUGH;
+                block.end = static_cast<uint16_t>(next);
+                block.successors.assign(1, static_cast<uint16_t>(next));
+                break;
+            }
+            address = next;
+        }
+        graph.blocks.push_back(std::move(block));
+    }
+
+    // Pass 3: what each block reads, draws and stores through I
+    for (const Block &block : graph.blocks)
+        followIndex(graph, image, block);
+    return graph;
+}
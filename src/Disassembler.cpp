@@ -0,0 +1,309 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Names and assembly text for decoded instructions
+ *****************************************************************************/
+
+#include "Disassembler.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <map>
+#include <vector>
+
+namespace
+{
+const char *const OP_NAMES[] = {
+    "OP_NULL",
+    "OP_00E0", "OP_00EE", "OP_1nnn", "OP_2nnn", "OP_3xnn", "OP_4xnn", "OP_5xy0",
+    "OP_6xnn", "OP_7xnn", "OP_8xy0", "OP_8xy1", "OP_8xy2", "OP_8xy3", "OP_8xy4",
+    "OP_8xy5", "OP_8xy6", "OP_8xy7", "OP_8xyE", "OP_9xy0", "OP_Annn", "OP_Bnnn",
+    "OP_Cxnn", "OP_Dxyn", "OP_Ex9e", "OP_Exa1", "OP_Fx07", "OP_Fx0a", "OP_Fx15",
+    "OP_Fx18", "OP_Fx1e", "OP_Fx29", "OP_Fx33", "OP_Fx55", "OP_Fx65",
+    "OP_00Cn", "OP_00FB", "OP_00FC", "OP_00FD", "OP_00FE", "OP_00FF", "OP_Fx30",
+    "OP_Fx75", "OP_Fx85",
+    "OP_00Dn", "OP_5xy2", "OP_5xy3", "OP_F000", "OP_Fx01", "OP_F002", "OP_Fx3a",
+};
+static_assert(sizeof(OP_NAMES) / sizeof(OP_NAMES[0]) == static_cast<size_t>(Op::COUNT),
+              "OP_NAMES must list every Op");
+
+bool equalsIgnoringCase(const char *a, const char *b)
+{
+    for (; *a && *b; ++a, ++b)
+    {
+        if (std::tolower(static_cast<unsigned char>(*a)) != std::tolower(static_cast<unsigned char>(*b)))
+            return false;
+    }
+    return *a == *b;
+}
+
+const char *kindName(ControlFlow::Byte kind)
+{
+    switch (kind)
+    {
+    case ControlFlow::Byte::SPRITE: return "sprite";
+    case ControlFlow::Byte::DATA: return "data";
+    default: return "unreached";
+    }
+}
+
+// Where control goes after a block's last instruction, as a comment
+std::string describeExit(const ControlFlow::Block &block)
+{
+    using ControlFlow::Terminator;
+    char text[64];
+    switch (block.terminator)
+    {
+    case Terminator::RETURN: return "return";
+    case Terminator::HALT: return "halt";
+    case Terminator::END: return "runs off the end of the image";
+    case Terminator::INDIRECT:
+        std::snprintf(text, sizeof(text), "-> 0x%03X + register", block.target);
+        return text;
+    case Terminator::JUMP:
+        if (block.target == block.last)
+            return "-> itself (stops here)";
+        break;
+    default:
+        break;
+    }
+
+    std::string exits = "->";
+    for (size_t i = 0; i < block.successors.size(); ++i)
+    {
+        std::snprintf(text, sizeof(text), "%s 0x%04X", i ? "," : "", block.successors[i]);
+        exits += text;
+    }
+    if (block.terminator == Terminator::CALL)
+    {
+        std::snprintf(text, sizeof(text), " after calling 0x%04X", block.target);
+        exits += text;
+    }
+    return exits;
+}
+} // namespace
+
+const char *Disassembler::OpName(Op op)
+{
+    size_t i = static_cast<size_t>(op);
+    return i < static_cast<size_t>(Op::COUNT) ? OP_NAMES[i] : "unknown";
+}
+
+bool Disassembler::ParseOpName(const char *name, Op &op)
+{
+    for (size_t i = 0; i < static_cast<size_t>(Op::COUNT); ++i)
+    {
+        if (equalsIgnoringCase(name, OP_NAMES[i]) || equalsIgnoringCase(name, OP_NAMES[i] + 3))
+        {
+            op = static_cast<Op>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string Disassembler::Format(uint16_t opcode)
+{
+    const Instr in = Processor::decode(opcode);
+    const unsigned int x = in.x;
+    const unsigned int y = in.y;
+    char text[32];
+
+    switch (in.op)
+    {
+    case Op::OP_00E0: std::snprintf(text, sizeof(text), "CLS"); break;
+    case Op::OP_00EE: std::snprintf(text, sizeof(text), "RET"); break;
+    case Op::OP_1nnn: std::snprintf(text, sizeof(text), "JP 0x%03X", in.nnn); break;
+    case Op::OP_2nnn: std::snprintf(text, sizeof(text), "CALL 0x%03X", in.nnn); break;
+    case Op::OP_3xnn: std::snprintf(text, sizeof(text), "SE V%X, 0x%02X", x, in.nn); break;
+    case Op::OP_4xnn: std::snprintf(text, sizeof(text), "SNE V%X, 0x%02X", x, in.nn); break;
+    case Op::OP_5xy0: std::snprintf(text, sizeof(text), "SE V%X, V%X", x, y); break;
+    case Op::OP_6xnn: std::snprintf(text, sizeof(text), "LD V%X, 0x%02X", x, in.nn); break;
+    case Op::OP_7xnn: std::snprintf(text, sizeof(text), "ADD V%X, 0x%02X", x, in.nn); break;
+    case Op::OP_8xy0: std::snprintf(text, sizeof(text), "LD V%X, V%X", x, y); break;
+    case Op::OP_8xy1: std::snprintf(text, sizeof(text), "OR V%X, V%X", x, y); break;
+    case Op::OP_8xy2: std::snprintf(text, sizeof(text), "AND V%X, V%X", x, y); break;
+    case Op::OP_8xy3: std::snprintf(text, sizeof(text), "XOR V%X, V%X", x, y); break;
+    case Op::OP_8xy4: std::snprintf(text, sizeof(text), "ADD V%X, V%X", x, y); break;
+    case Op::OP_8xy5: std::snprintf(text, sizeof(text), "SUB V%X, V%X", x, y); break;
+    case Op::OP_8xy6: std::snprintf(text, sizeof(text), "SHR V%X, V%X", x, y); break;
+    case Op::OP_8xy7: std::snprintf(text, sizeof(text), "SUBN V%X, V%X", x, y); break;
+    case Op::OP_8xyE: std::snprintf(text, sizeof(text), "SHL V%X, V%X", x, y); break;
+    case Op::OP_9xy0: std::snprintf(text, sizeof(text), "SNE V%X, V%X", x, y); break;
+    case Op::OP_Annn: std::snprintf(text, sizeof(text), "LD I, 0x%03X", in.nnn); break;
+    case Op::OP_Bnnn: std::snprintf(text, sizeof(text), "JP V0, 0x%03X", in.nnn); break;
+    case Op::OP_Cxnn: std::snprintf(text, sizeof(text), "RND V%X, 0x%02X", x, in.nn); break;
+    case Op::OP_Dxyn: std::snprintf(text, sizeof(text), "DRW V%X, V%X, %u", x, y, in.n); break;
+    case Op::OP_Ex9e: std::snprintf(text, sizeof(text), "SKP V%X", x); break;
+    case Op::OP_Exa1: std::snprintf(text, sizeof(text), "SKNP V%X", x); break;
+    case Op::OP_Fx07: std::snprintf(text, sizeof(text), "LD V%X, DT", x); break;
+    case Op::OP_Fx0a: std::snprintf(text, sizeof(text), "LD V%X, K", x); break;
+    case Op::OP_Fx15: std::snprintf(text, sizeof(text), "LD DT, V%X", x); break;
+    case Op::OP_Fx18: std::snprintf(text, sizeof(text), "LD ST, V%X", x); break;
+    case Op::OP_Fx1e: std::snprintf(text, sizeof(text), "ADD I, V%X", x); break;
+    case Op::OP_Fx29: std::snprintf(text, sizeof(text), "LD F, V%X", x); break;
+    case Op::OP_Fx33: std::snprintf(text, sizeof(text), "LD B, V%X", x); break;
+    case Op::OP_Fx55: std::snprintf(text, sizeof(text), "LD [I], V%X", x); break;
+    case Op::OP_Fx65: std::snprintf(text, sizeof(text), "LD V%X, [I]", x); break;
+    case Op::OP_00Cn: std::snprintf(text, sizeof(text), "SCD %u", in.n); break;
+    case Op::OP_00FB: std::snprintf(text, sizeof(text), "SCR"); break;
+    case Op::OP_00FC: std::snprintf(text, sizeof(text), "SCL"); break;
+    case Op::OP_00FD: std::snprintf(text, sizeof(text), "EXIT"); break;
+    case Op::OP_00FE: std::snprintf(text, sizeof(text), "LOW"); break;
+    case Op::OP_00FF: std::snprintf(text, sizeof(text), "HIGH"); break;
+    case Op::OP_Fx30: std::snprintf(text, sizeof(text), "LD HF, V%X", x); break;
+    case Op::OP_Fx75: std::snprintf(text, sizeof(text), "LD R, V%X", x); break;
+    case Op::OP_Fx85: std::snprintf(text, sizeof(text), "LD V%X, R", x); break;
+    case Op::OP_00Dn: std::snprintf(text, sizeof(text), "SCU %u", in.n); break;
+    case Op::OP_5xy2: std::snprintf(text, sizeof(text), "SAVE V%X-V%X", x, y); break;
+    case Op::OP_5xy3: std::snprintf(text, sizeof(text), "LOAD V%X-V%X", x, y); break;
+    case Op::OP_F000: std::snprintf(text, sizeof(text), "LD I, LONG"); break;
+    case Op::OP_Fx01: std::snprintf(text, sizeof(text), "PLANE %u", x); break;
+    case Op::OP_F002: std::snprintf(text, sizeof(text), "AUDIO"); break;
+    case Op::OP_Fx3a: std::snprintf(text, sizeof(text), "PITCH V%X", x); break;
+    default: std::snprintf(text, sizeof(text), "DW 0x%04X", opcode); break;
+    }
+    return text;
+}
+
+void Disassembler::Listing(std::ostream &out, const uint8_t *rom, size_t size, const ControlFlow::Graph &graph)
+{
+    using ControlFlow::Byte;
+    size = std::min(size, graph.bytes.size());
+
+    // Predecessors, from every edge and call
+    std::map<uint16_t, std::vector<uint16_t>> from;
+    for (const ControlFlow::Block &block : graph.blocks)
+    {
+        for (uint16_t next : block.successors)
+            from[next].push_back(block.last);
+        if (block.terminator == ControlFlow::Terminator::CALL)
+            from[block.target].push_back(block.last);
+    }
+    // Blocks by their last instruction, unless they just run on
+    std::map<uint16_t, const ControlFlow::Block *> exits;
+    for (const ControlFlow::Block &block : graph.blocks)
+    {
+        if (block.terminator != ControlFlow::Terminator::FALLTHROUGH)
+            exits[block.last] = &block;
+    }
+    std::map<uint16_t, const ControlFlow::Store *> stores;
+    for (const ControlFlow::Store &store : graph.stores)
+        stores[store.pc] = &store;
+
+    char line[160];
+    Byte run = Byte::CODE;
+    for (size_t offset = 0; offset < size;)
+    {
+        const unsigned int address = START_ADDRESS + static_cast<unsigned int>(offset);
+        const Byte kind = graph.bytes[offset];
+
+        if (kind == Byte::OPERAND)
+        {
+            ++offset;
+            continue;
+        }
+        if (kind != Byte::CODE)
+        {
+            if (kind != run)
+                out << "\n; " << kindName(kind) << "\n";
+            run = kind;
+
+            if (kind == Byte::SPRITE)
+            {
+                char pixels[9] = {};
+                for (unsigned int b = 0; b < 8; ++b)
+                    pixels[b] = (rom[offset] >> (7 - b)) & 1 ? '#' : '.';
+                std::snprintf(line, sizeof(line), "0x%04X  %02X    %s\n", address, rom[offset], pixels);
+                out << line;
+                ++offset;
+                continue;
+            }
+
+            // Up to eight bytes of the same kind on a line
+            int length = std::snprintf(line, sizeof(line), "0x%04X  DB ", address);
+            size_t end = offset;
+            while (end < size && end - offset < 8 && graph.bytes[end] == kind)
+            {
+                length += std::snprintf(line + length, sizeof(line) - length, "%s0x%02X",
+                                        end == offset ? "" : ", ", rom[end]);
+                ++end;
+            }
+            out << line << "\n";
+            offset = end;
+            continue;
+        }
+
+        const ControlFlow::Block *block = graph.BlockAt(static_cast<uint16_t>(address));
+        if (block)
+        {
+            bool subroutine = std::binary_search(graph.subroutines.begin(), graph.subroutines.end(), block->start);
+            std::snprintf(line, sizeof(line), "\n; %s 0x%04X-0x%04X", subroutine ? "subroutine" : "block",
+                          block->start, block->end - 1);
+            out << line;
+            auto preds = from.find(block->start);
+            if (address == START_ADDRESS)
+                out << ", entry";
+            if (preds != from.end())
+            {
+                out << ", from";
+                for (size_t i = 0; i < preds->second.size(); ++i)
+                {
+                    std::snprintf(line, sizeof(line), "%s 0x%04X", i ? "," : "", preds->second[i]);
+                    out << line;
+                }
+            }
+            out << "\n";
+        }
+        run = Byte::CODE;
+
+        uint16_t opcode = static_cast<uint16_t>((rom[offset] << 8) | (offset + 1 < size ? rom[offset + 1] : 0));
+        Instr in = Processor::decode(opcode);
+        std::string text = Format(opcode);
+        int length;
+        if (in.op == Op::OP_F000 && offset + 3 < size)
+        {
+            unsigned int operand = (rom[offset + 2] << 8) | rom[offset + 3];
+            std::snprintf(line, sizeof(line), "LD I, 0x%04X", operand);
+            text = line;
+            length = std::snprintf(line, sizeof(line), "0x%04X  %04X %04X  %-8s %-18s", address, opcode, operand,
+                                   OpName(in.op), text.c_str());
+        }
+        else
+        {
+            length = std::snprintf(line, sizeof(line), "0x%04X  %04X       %-8s %-18s", address, opcode,
+                                   OpName(in.op), text.c_str());
+        }
+
+        // Comments: the block's exit on its last instruction, and stores
+        std::string comment;
+        auto exit = exits.find(static_cast<uint16_t>(address));
+        if (exit != exits.end())
+            comment = describeExit(*exit->second);
+        auto store = stores.find(static_cast<uint16_t>(address));
+        if (store != stores.end())
+        {
+            const ControlFlow::Store &s = *store->second;
+            char note[64];
+            if (!s.known)
+                std::snprintf(note, sizeof(note), "writes through an unknown I");
+            else if (s.hitsCode)
+                std::snprintf(note, sizeof(note), "self-modifying: writes 0x%04X-0x%04X", s.first, s.last);
+            else
+                note[0] = '\0';
+            if (note[0])
+                comment += (comment.empty() ? "" : "; ") + std::string(note);
+        }
+        if (!comment.empty())
+            std::snprintf(line + length, sizeof(line) - length, " ; %s", comment.c_str());
+        else
+        {
+            while (length > 0 && line[length - 1] == ' ')
+                line[--length] = '\0';
+        }
+        out << line << "\n";
+        offset += 2;
+    }
+}
@@ -0,0 +1,286 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Converts captured frames and writes them on a background thread
+ *
+ * Delta RAW layout, per frame:
+ *   u64               little-endian mask, bit y set when row y changed
+ *                     (all rows for the first frame, none for a repeat)
+ *   bytes             16 per changed row in ascending order, 1 bit per
+ *                     pixel, MSB first, 1 = lit
+ * Plain RAW frames are all 64 rows without the mask: 1024 bytes each.
+ *****************************************************************************/
+
+#include "FrameSink.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+const char *const FORMAT_NAMES[] = {"raw", "y4m", "pbm"};
+
+// How long the writer rests when there is nothing to write; frames arrive
+// at 60 Hz from a paced frontend
+const std::chrono::milliseconds DRAIN_INTERVAL(1);
+
+// Greys matching Processor::render_rgba: off, plane 0, plane 1, both
+const uint8_t LUMA[4] = {0x00, 0xFF, 0xAA, 0x55};
+
+// Each bit of `half` twice over, for pixel-doubling a low-resolution row
+uint64_t spread(uint32_t half)
+{
+    uint64_t x = half;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+    x = (x | (x << 2)) & 0x3333333333333333ull;
+    x = (x | (x << 1)) & 0x5555555555555555ull;
+    return x | (x << 1);
+}
+
+void putWord(std::vector<uint8_t> &out, uint64_t word, bool invert)
+{
+    if (invert)
+        word = ~word;
+    for (int shift = 56; shift >= 0; shift -= 8)
+        out.push_back(static_cast<uint8_t>(word >> shift));
+}
+} // namespace
+
+bool FrameSink::ParseFormat(const char *name, Format &format)
+{
+    for (size_t i = 0; i < sizeof(FORMAT_NAMES) / sizeof(FORMAT_NAMES[0]); ++i)
+    {
+        if (std::strcmp(name, FORMAT_NAMES[i]) == 0)
+        {
+            format = static_cast<Format>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+int FrameSink::Open(const char *filename, const Options &requested)
+{
+    Close();
+
+    if (requested.delta && requested.format != Format::RAW)
+    {
+        std::cerr << "Delta encoding is only defined for raw frames\n";
+        return 1;
+    }
+    if (requested.every == 0)
+    {
+        std::cerr << "Frame decimation must keep at least one frame in every N\n";
+        return 1;
+    }
+
+    out = std::strcmp(filename, "-") == 0 ? stdout : std::fopen(filename, "wb");
+    if (!out)
+    {
+        std::cerr << "Failed to open frame output: " << filename << "\n";
+        return 1;
+    }
+    options = requested;
+    if (options.format == Format::Y4M)
+        std::fprintf(out, "YUV4MPEG2 W%u H%u F60:%u Ip A1:1 Cmono\n", HIRES_WIDTH, HIRES_HEIGHT, options.every);
+
+    size_t size = 1;
+    while (size < options.capacity)
+        size <<= 1;
+    ring.assign(size, Slot{});
+    mask = size - 1;
+
+    frames = kept = dropped = written = 0;
+    captured = false;
+    failed = false;
+    std::memset(shown, 0, sizeof(shown));
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    stopping.store(false, std::memory_order_relaxed);
+    writer = std::thread(&FrameSink::drain, this);
+    return 0;
+}
+
+int FrameSink::Close()
+{
+    if (!writer.joinable())
+        return 0;
+
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+
+    // Frames dropped after the last one written still take their place
+    Slot repeat{};
+    repeat.repeat = true;
+    while (written < kept)
+    {
+        repeat.number = written;
+        write(repeat);
+    }
+
+    bool ok = !failed && std::fflush(out) == 0;
+    if (out != stdout)
+        ok = std::fclose(out) == 0 && ok;
+    out = nullptr;
+    if (!ok)
+    {
+        std::cerr << "Error writing frames\n";
+        return 1;
+    }
+    return 0;
+}
+
+void FrameSink::Capture(const Processor &cpu)
+{
+    ++frames;
+    if (frames <= options.skip || (frames - options.skip - 1) % options.every != 0)
+        return;
+    uint64_t number = kept++;
+
+    uint64_t h = head.load(std::memory_order_relaxed);
+    while (h - tail.load(std::memory_order_acquire) > mask)
+    {
+        if (!options.wait)
+        {
+            // The writer repeats the previous frame in its place. The next
+            // capture must copy: the display may have changed meanwhile.
+            ++dropped;
+            captured = false;
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    Slot &slot = ring[h & mask];
+    slot.number = number;
+    slot.hires = cpu.is_hires();
+    slot.repeat = captured && cpu.display_generation() == lastGeneration && slot.hires == lastHires;
+    if (!slot.repeat)
+        std::memcpy(slot.display, cpu.display, sizeof(slot.display));
+    head.store(h + 1, std::memory_order_release);
+
+    captured = true;
+    lastGeneration = cpu.display_generation();
+    lastHires = slot.hires;
+}
+
+void FrameSink::drain()
+{
+    // Stand-in for frames the producer had to drop
+    Slot repeat{};
+    repeat.repeat = true;
+
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        // Read the flag first: once it is seen, every frame is already
+        // visible and one more pass writes the rest
+        bool last = stopping.load(std::memory_order_acquire);
+        uint64_t h = head.load(std::memory_order_acquire);
+
+        for (; t != h; ++t)
+        {
+            const Slot &slot = ring[t & mask];
+            while (written < slot.number)
+            {
+                repeat.number = written;
+                write(repeat);
+            }
+            write(slot);
+            tail.store(t + 1, std::memory_order_release);
+        }
+
+        if (last)
+            break;
+        if (t == h)
+            std::this_thread::sleep_for(DRAIN_INTERVAL);
+    }
+}
+
+void FrameSink::write(const Slot &slot)
+{
+    uint64_t changed = 0;
+    if (!slot.repeat)
+    {
+        for (unsigned int p = 0; p < DISPLAY_PLANES; ++p)
+        {
+            for (unsigned int y = 0; y < HIRES_HEIGHT; ++y)
+            {
+                uint64_t row[ROW_WORDS];
+                if (slot.hires)
+                {
+                    std::memcpy(row, slot.display[p][y], sizeof(row));
+                }
+                else
+                {
+                    uint64_t source = slot.display[p][y / 2][0];
+                    row[0] = spread(static_cast<uint32_t>(source >> 32));
+                    row[1] = spread(static_cast<uint32_t>(source));
+                }
+                if (std::memcmp(row, shown[p][y], sizeof(row)) != 0)
+                    changed |= 1ull << y;
+                std::memcpy(shown[p][y], row, sizeof(row));
+            }
+        }
+    }
+    if (written == 0)
+        changed = ~0ull;
+    ++written;
+
+    buffer.clear();
+    switch (options.format)
+    {
+    case Format::RAW:
+        if (options.delta)
+        {
+            for (unsigned int i = 0; i < 8; ++i)
+                buffer.push_back(static_cast<uint8_t>(changed >> (8 * i)));
+        }
+        for (unsigned int y = 0; y < HIRES_HEIGHT; ++y)
+        {
+            if (options.delta && !((changed >> y) & 1u))
+                continue;
+            for (unsigned int w = 0; w < ROW_WORDS; ++w)
+                putWord(buffer, shown[0][y][w] | shown[1][y][w], false);
+        }
+        break;
+
+    case Format::PBM:
+    {
+        // PBM's 1 is black: lit pixels are written as 0 to look like the screen
+        char header[32];
+        int length = std::snprintf(header, sizeof(header), "P4\n%u %u\n", HIRES_WIDTH, HIRES_HEIGHT);
+        buffer.insert(buffer.end(), header, header + length);
+        for (unsigned int y = 0; y < HIRES_HEIGHT; ++y)
+        {
+            for (unsigned int w = 0; w < ROW_WORDS; ++w)
+                putWord(buffer, shown[0][y][w] | shown[1][y][w], true);
+        }
+        break;
+    }
+
+    case Format::Y4M:
+    {
+        static const char FRAME_HEADER[] = "FRAME\n";
+        buffer.insert(buffer.end(), FRAME_HEADER, FRAME_HEADER + sizeof(FRAME_HEADER) - 1);
+        for (unsigned int y = 0; y < HIRES_HEIGHT; ++y)
+        {
+            for (unsigned int w = 0; w < ROW_WORDS; ++w)
+            {
+                uint64_t low = shown[0][y][w];
+                uint64_t high = shown[1][y][w];
+                for (int shift = 63; shift >= 0; --shift)
+                    buffer.push_back(LUMA[((low >> shift) & 1u) | (((high >> shift) & 1u) << 1u)]);
+            }
+        }
+        break;
+    }
+    }
+
+    if (!failed && std::fwrite(buffer.data(), 1, buffer.size(), out) != buffer.size())
+        failed = true;
+}
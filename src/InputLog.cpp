@@ -0,0 +1,249 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Implements session recording and replay
+ *
+ * Layout (all integers little-endian):
+ *   "C8IR"            magic
+ *   u16               format version
+ *   u64               random seed
+ *   u8                random engine (0 xoshiro128++, 1 PCG32)
+ *   u8                quirk profile (Quirks::Profile)
+ *   u64               instructions/second, as IEEE-754 bits
+ *   u64               FNV-1a hash of the ROM image
+ *   u32               ROM size in bytes
+ *   records, each:
+ *     varint          (instructions since the previous record << 1) | end
+ *     u16             keypad, bit k set when key k is down; absent for end
+ *
+ * Varints are LEB128: seven bits per byte, low bits first, high bit set on
+ * every byte but the last. A key change typically takes three or four
+ * bytes. The end record is always last; a session cut short by a crash has
+ * none and replays up to its last key change.
+ *****************************************************************************/
+
+#include "InputLog.hpp"
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+namespace
+{
+const char SESSION_MAGIC[4] = {'C', '8', 'I', 'R'};
+const uint16_t SESSION_VERSION = 1;
+
+void putBytes(std::ofstream &out, uint64_t v, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+        out.put(static_cast<char>(v >> (8 * i)));
+}
+
+void putVarint(std::ofstream &out, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        out.put(static_cast<char>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.put(static_cast<char>(v));
+}
+
+// Reads past the end leave `ok` false and yield zeros
+class SessionReader
+{
+  public:
+    SessionReader(const uint8_t *data, size_t size) : p(data), end(data + size) {}
+
+    bool ok() const { return good; }
+    bool done() const { return p == end; }
+
+    uint64_t bytes(unsigned int count)
+    {
+        if (!good || static_cast<size_t>(end - p) < count)
+        {
+            good = false;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (unsigned int i = 0; i < count; ++i)
+            v |= static_cast<uint64_t>(*p++) << (8 * i);
+        return v;
+    }
+    uint64_t varint()
+    {
+        uint64_t v = 0;
+        for (unsigned int shift = 0; shift < 64; shift += 7)
+        {
+            uint64_t byte = bytes(1);
+            v |= (byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return v;
+        }
+        good = false;
+        return 0;
+    }
+
+  private:
+    const uint8_t *p;
+    const uint8_t *end;
+    bool good{true};
+};
+
+uint16_t packKeys(const uint8_t *keypad)
+{
+    uint16_t keys = 0;
+    for (unsigned int k = 0; k < NUM_KEYS; ++k)
+    {
+        if (keypad[k])
+            keys |= static_cast<uint16_t>(1u << k);
+    }
+    return keys;
+}
+} // namespace
+
+void SessionInfo::Apply(Processor &cpu) const
+{
+    cpu.seed_random(seed, engine);
+    cpu.set_quirks(quirks);
+    cpu.set_instructions_per_second(instructionsPerSecond);
+}
+
+uint64_t SessionInfo::HashRom(const uint8_t *data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+int InputRecorder::Open(const char *filename, const SessionInfo &info)
+{
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open session for writing: " << filename << "\n";
+        return 1;
+    }
+
+    uint64_t ips;
+    std::memcpy(&ips, &info.instructionsPerSecond, sizeof(ips));
+
+    file.write(SESSION_MAGIC, sizeof(SESSION_MAGIC));
+    putBytes(file, SESSION_VERSION, 2);
+    putBytes(file, info.seed, 8);
+    putBytes(file, static_cast<uint8_t>(info.engine), 1);
+    putBytes(file, static_cast<uint8_t>(info.quirks), 1);
+    putBytes(file, ips, 8);
+    putBytes(file, info.romHash, 8);
+    putBytes(file, info.romSize, 4);
+
+    // Power-on is all keys up
+    lastCycle = 0;
+    lastKeys = 0;
+    return file ? 0 : 1;
+}
+
+void InputRecorder::Sample(uint64_t cycle, const uint8_t *keypad)
+{
+    uint16_t keys = packKeys(keypad);
+    if (!file.is_open() || keys == lastKeys)
+        return;
+
+    writeRecord(cycle, false);
+    putBytes(file, keys, 2);
+    lastKeys = keys;
+
+    // Key changes come at human rates; flushing each keeps everything up to
+    // a crash replayable
+    file.flush();
+}
+
+int InputRecorder::Close(uint64_t cycle)
+{
+    if (!file.is_open())
+        return 1;
+
+    writeRecord(cycle, true);
+    file.close();
+    if (!file)
+    {
+        std::cerr << "Error writing session\n";
+        return 1;
+    }
+    return 0;
+}
+
+void InputRecorder::writeRecord(uint64_t cycle, bool end)
+{
+    putVarint(file, ((cycle - lastCycle) << 1) | (end ? 1u : 0u));
+    lastCycle = cycle;
+}
+
+int InputReplay::Load(const char *filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open session: " << filename << "\n";
+        return 1;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    SessionReader r(data.data(), data.size());
+    char magic[sizeof(SESSION_MAGIC)];
+    for (char &c : magic)
+        c = static_cast<char>(r.bytes(1));
+    uint16_t version = static_cast<uint16_t>(r.bytes(2));
+    if (!r.ok() || std::memcmp(magic, SESSION_MAGIC, sizeof(magic)) != 0)
+    {
+        std::cerr << "Not a CHIP-8 session recording: " << filename << "\n";
+        return 1;
+    }
+    if (version != SESSION_VERSION)
+    {
+        std::cerr << "Unsupported session version: " << version << "\n";
+        return 1;
+    }
+
+    SessionInfo loaded;
+    loaded.seed = r.bytes(8);
+    uint8_t engine = static_cast<uint8_t>(r.bytes(1));
+    uint8_t profile = static_cast<uint8_t>(r.bytes(1));
+    uint64_t ips = r.bytes(8);
+    std::memcpy(&loaded.instructionsPerSecond, &ips, sizeof(ips));
+    loaded.romHash = r.bytes(8);
+    loaded.romSize = static_cast<uint32_t>(r.bytes(4));
+    loaded.engine = static_cast<Random::Engine>(engine);
+    loaded.quirks = static_cast<Quirks::Profile>(profile);
+
+    std::vector<Event> loadedEvents;
+    uint64_t cycle = 0;
+    bool ended = false;
+    while (r.ok() && !r.done() && !ended)
+    {
+        uint64_t record = r.varint();
+        cycle += record >> 1;
+        ended = record & 1u;
+        if (!ended)
+            loadedEvents.push_back(Event{cycle, static_cast<uint16_t>(r.bytes(2))});
+    }
+
+    if (!r.ok() || !r.done() || engine > static_cast<uint8_t>(Random::Engine::PCG) ||
+        profile >= static_cast<uint8_t>(Quirks::Profile::COUNT) || !(loaded.instructionsPerSecond > 0))
+    {
+        std::cerr << "Corrupt or truncated session: " << filename << "\n";
+        return 1;
+    }
+    if (!ended)
+        std::cerr << "Session has no end record, replaying to its last key change\n";
+
+    info = loaded;
+    events.swap(loadedEvents);
+    endCycle = cycle;
+    return 0;
+}
@@ -0,0 +1,1016 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Implements the x86-64 basic-block JIT
+ *****************************************************************************/
+
+#include "Jit.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__))
+#define CHIP8_JIT_X64 1
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+enum HostReg : int
+{
+    RAX = 0, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+    R8, R9, R10, R11, R12, R13, R14, R15
+};
+
+enum Cond : uint8_t
+{
+    CC_B = 0x2,
+    CC_AE = 0x3,
+    CC_E = 0x4,
+    CC_NE = 0x5
+};
+
+// Host registers guest state can be pinned to. rax is scratch and rdi holds
+// the pointer to the guest register file for the whole block. rsi brings in
+// the pointer to guest memory, which a block that needs it copies to a pool
+// register before loading guest registers.
+const int POOL[] = {RCX, RDX, RSI, R8, R9, R10, R11, RBX, RBP, R12, R13, R14, R15};
+const unsigned int POOL_SIZE = sizeof(POOL) / sizeof(POOL[0]);
+
+bool calleeSaved(int reg)
+{
+    return reg == RBX || reg == RBP || reg >= R12;
+}
+
+// Minimal x86-64 encoder for the handful of forms the JIT needs. Guest
+// values live zero-extended in 32-bit host registers. Memory operands are
+// [rdi + disp32] into the Processor, [rdi + rax*2 + disp32] into its stack,
+// or a plain [reg] holding a pointer into guest memory.
+class Emitter
+{
+  public:
+    explicit Emitter(uint8_t *out) : start(out), p(out) {}
+    size_t size() const { return static_cast<size_t>(p - start); }
+
+    void movImm(int r, uint32_t imm)
+    {
+        if (r & 8)
+            byte(0x41);
+        byte(0xB8 + (r & 7));
+        u32(imm);
+    }
+
+    // opc r/m32(dst), r32(src): 01 add, 09 or, 21 and, 29 sub, 31 xor, 39 cmp, 89 mov
+    void alu(uint8_t opc, int dst, int src)
+    {
+        rex(src, dst);
+        byte(opc);
+        modrm(3, src, dst);
+    }
+
+    // 81 /ext r/m32, imm32: 0 add, 4 and, 5 sub, 7 cmp
+    void aluImm(int ext, int r, uint32_t imm)
+    {
+        rex(0, r);
+        byte(0x81);
+        modrm(3, ext, r);
+        u32(imm);
+    }
+
+    // C1 /ext r/m32, imm8: 4 shl, 5 shr
+    void shift(int ext, int r, uint8_t count)
+    {
+        rex(0, r);
+        byte(0xC1);
+        modrm(3, ext, r);
+        byte(count);
+    }
+
+    void imulImm(int dst, int src, uint32_t imm) // imul r32, r/m32, imm32
+    {
+        rex(dst, src);
+        byte(0x69);
+        modrm(3, dst, src);
+        u32(imm);
+    }
+
+    // 64-bit alu for pointers: 01 add, 89 mov
+    void alu64(uint8_t opc, int dst, int src)
+    {
+        byte(0x48 | ((src & 8) ? 4 : 0) | ((dst & 8) ? 1 : 0));
+        byte(opc);
+        modrm(3, src, dst);
+    }
+
+    void loadByte(int r, int32_t disp) // movzx r32, byte [rdi+disp]
+    {
+        rex(r, RDI);
+        byte(0x0F);
+        byte(0xB6);
+        modrm(2, r, RDI);
+        u32(static_cast<uint32_t>(disp));
+    }
+
+    void storeByte(int r, int32_t disp) // mov byte [rdi+disp], r8
+    {
+        // Always emit REX so 5/6 encode bpl/sil rather than ch/dh
+        byte(0x40 | ((r & 8) ? 4 : 0));
+        byte(0x88);
+        modrm(2, r, RDI);
+        u32(static_cast<uint32_t>(disp));
+    }
+
+    void loadWord(int r, int32_t disp) // movzx r32, word [rdi+disp]
+    {
+        rex(r, RDI);
+        byte(0x0F);
+        byte(0xB7);
+        modrm(2, r, RDI);
+        u32(static_cast<uint32_t>(disp));
+    }
+
+    void storeWord(int r, int32_t disp) // mov word [rdi+disp], r16
+    {
+        byte(0x66);
+        rex(r, RDI);
+        byte(0x89);
+        modrm(2, r, RDI);
+        u32(static_cast<uint32_t>(disp));
+    }
+
+    void loadByteAt(int r, int ptr) // movzx r32, byte [ptr]
+    {
+        rex(r, ptr);
+        byte(0x0F);
+        byte(0xB6);
+        pointer(r, ptr);
+    }
+
+    void storeByteAt(int r, int ptr) // mov byte [ptr], r8
+    {
+        byte(0x40 | ((r & 8) ? 4 : 0) | ((ptr & 8) ? 1 : 0));
+        byte(0x88);
+        pointer(r, ptr);
+    }
+
+    void loadStackSlot(int r, int32_t disp) // movzx r32, word [rdi+rax*2+disp]
+    {
+        rex(r, 0);
+        byte(0x0F);
+        byte(0xB7);
+        modrm(2, r, RSP);
+        byte(0x47); // SIB: scale 2, index rax, base rdi
+        u32(static_cast<uint32_t>(disp));
+    }
+
+    void storeStackSlot(uint16_t imm, int32_t disp) // mov word [rdi+rax*2+disp], imm16
+    {
+        byte(0x66);
+        byte(0xC7);
+        modrm(2, 0, RSP);
+        byte(0x47);
+        u32(static_cast<uint32_t>(disp));
+        byte(static_cast<uint8_t>(imm));
+        byte(static_cast<uint8_t>(imm >> 8));
+    }
+
+    // Short forward jcc; bind() lands it on whatever is emitted next
+    uint8_t *jump(uint8_t cc)
+    {
+        byte(0x70 | cc);
+        byte(0);
+        return p - 1;
+    }
+
+    void bind(uint8_t *rel) { *rel = static_cast<uint8_t>(p - (rel + 1)); }
+
+    void setccEax(uint8_t cc) // setcc al; movzx eax, al
+    {
+        byte(0x0F);
+        byte(0x90 | cc);
+        byte(0xC0);
+        byte(0x0F);
+        byte(0xB6);
+        byte(0xC0);
+    }
+
+    void cmov(uint8_t cc, int dst, int src)
+    {
+        rex(dst, src);
+        byte(0x0F);
+        byte(0x40 | cc);
+        modrm(3, dst, src);
+    }
+
+    void push(int r)
+    {
+        if (r & 8)
+            byte(0x41);
+        byte(0x50 + (r & 7));
+    }
+
+    void pop(int r)
+    {
+        if (r & 8)
+            byte(0x41);
+        byte(0x58 + (r & 7));
+    }
+
+    void ret() { byte(0xC3); }
+
+  private:
+    void byte(uint8_t b) { *p++ = b; }
+
+    void u32(uint32_t v)
+    {
+        std::memcpy(p, &v, sizeof(v));
+        p += sizeof(v);
+    }
+
+    void rex(int reg, int rm)
+    {
+        uint8_t prefix = 0x40 | ((reg & 8) ? 4 : 0) | ((rm & 8) ? 1 : 0);
+        if (prefix != 0x40)
+            byte(prefix);
+    }
+
+    void modrm(int mod, int reg, int rm)
+    {
+        byte(static_cast<uint8_t>((mod << 6) | ((reg & 7) << 3) | (rm & 7)));
+    }
+
+    // [ptr] as [ptr + disp8 0], which also covers rbp/r13; rsp/r12 need a SIB
+    void pointer(int reg, int ptr)
+    {
+        modrm(1, reg, ptr);
+        if ((ptr & 7) == RSP)
+            byte(0x24);
+        byte(0);
+    }
+
+    uint8_t *start;
+    uint8_t *p;
+};
+
+// Guest registers an instruction touches, as a 16-bit mask, and whether it
+// touches index or guest memory. Returns false for instructions the JIT
+// does not translate.
+bool footprint(const Instr &in, const Quirks::Set &quirks, uint16_t &regs, bool &usesIndex,
+               bool &usesMemory, bool &terminator)
+{
+    const uint16_t X = 1u << in.x, Y = 1u << in.y, F = 1u << 0xF;
+    regs = 0;
+    usesIndex = false;
+    usesMemory = false;
+    terminator = false;
+
+    switch (in.op)
+    {
+    case Op::OP_6xnn:
+    case Op::OP_7xnn:
+        regs = X;
+        return true;
+    case Op::OP_8xy0:
+        regs = X | Y;
+        return true;
+    case Op::OP_8xy1:
+    case Op::OP_8xy2:
+    case Op::OP_8xy3:
+        regs = X | Y | (quirks.logicResetsVf ? F : 0);
+        return true;
+    case Op::OP_8xy4:
+    case Op::OP_8xy5:
+    case Op::OP_8xy7:
+        regs = X | Y | F;
+        return true;
+    case Op::OP_8xy6:
+    case Op::OP_8xyE:
+        // A shift whose source or destination is VF needs a second scratch
+        // register to keep the source alive past the flag write
+        if (in.x == 0xF || (quirks.shiftUsesVy && in.y == 0xF))
+            return false;
+        regs = X | F | (quirks.shiftUsesVy ? Y : 0);
+        return true;
+    case Op::OP_Annn:
+        usesIndex = true;
+        return true;
+    case Op::OP_Fx1e:
+        regs = X;
+        usesIndex = true;
+        return true;
+    case Op::OP_Fx07:
+    case Op::OP_Fx15:
+    case Op::OP_Fx18:
+        // Timers only move between run() calls, so blocks may read and
+        // write them directly
+        regs = X;
+        return true;
+    case Op::OP_Fx33:
+    case Op::OP_Fx55:
+        // A store ends its block, so the dispatcher can note it and drop
+        // any block it overwrote before the next lookup. FX55 moves guest
+        // registers as they stand, pinned or not.
+        regs = in.op == Op::OP_Fx33 ? X : 0;
+        usesIndex = true;
+        usesMemory = true;
+        terminator = true;
+        return true;
+    case Op::OP_Fx65:
+        usesIndex = true;
+        usesMemory = true;
+        return true;
+    case Op::OP_1nnn:
+    case Op::OP_2nnn:
+    case Op::OP_00EE:
+        terminator = true;
+        return true;
+    case Op::OP_Bnnn:
+        regs = quirks.jumpUsesVx ? X : 1u;
+        terminator = true;
+        return true;
+    case Op::OP_3xnn:
+    case Op::OP_4xnn:
+        // Long skips depend on the instruction after the block
+        if (quirks.longSkips)
+            return false;
+        regs = X;
+        terminator = true;
+        return true;
+    case Op::OP_5xy0:
+    case Op::OP_9xy0:
+        if (quirks.longSkips)
+            return false;
+        regs = X | Y;
+        terminator = true;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Upper bound on the code emitted for an instruction, leaving the prologue
+// and one epilogue out
+unsigned int emittedBytes(const Instr &in)
+{
+    switch (in.op)
+    {
+    case Op::OP_Fx33: return 160;
+    case Op::OP_Fx55:
+    case Op::OP_Fx65: return 40 * (in.x + 1u);
+    default: return 48;
+    }
+}
+
+unsigned int popcount16(uint16_t v)
+{
+    unsigned int n = 0;
+    for (; v; v &= v - 1)
+        ++n;
+    return n;
+}
+} // namespace
+
+Jit::Jit(Processor &cpu) : cpu(cpu), quirks(cpu.get_quirks())
+{
+    // Profiling builds interpret everything so each guest instruction is counted
+#if defined(CHIP8_JIT_X64) && !defined(CHIP8_PROFILE)
+    void *mem = mmap(nullptr, CODE_BUFFER_BYTES, PROT_READ | PROT_EXEC,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem != MAP_FAILED)
+        code = static_cast<uint8_t *>(mem);
+#endif
+}
+
+Jit::~Jit()
+{
+#ifdef CHIP8_JIT_X64
+    if (code)
+        munmap(code, CODE_BUFFER_BYTES);
+#endif
+}
+
+void Jit::flush()
+{
+    std::memset(blocks, 0, sizeof(blocks));
+    for (auto &page : partials)
+        page.clear();
+    std::memset(codeBytes, 0, sizeof(codeBytes));
+    codeUsed = 0;
+}
+
+void Jit::prebuild(const ControlFlow::Graph &graph)
+{
+    if (!code)
+        return;
+    for (const ControlFlow::Block &block : graph.blocks)
+        lookup(block.start);
+}
+
+Jit::Block &Jit::lookup(uint16_t pc)
+{
+    static Block interpreted{nullptr, 0, 1, State::INTERPRETED, 0, 0};
+
+    // Misaligned or wrapped program counters always go to the interpreter
+    if ((pc & 1u) || pc >= cpu.memory.Size() - 1)
+        return interpreted;
+
+    Block &block = blocks[pc];
+    if (block.state == State::EMPTY)
+        block = compile(pc, MAX_BLOCK_INSTRUCTIONS);
+    return block;
+}
+
+Jit::Block &Jit::lookupPartial(uint16_t pc, unsigned int count)
+{
+    auto &page = partials[pc >> PAGE_BITS];
+    uint32_t key = (static_cast<uint32_t>(pc) << 8) | count;
+    auto found = page.find(key);
+    if (found != page.end())
+        return found->second;
+
+    Block block = compile(pc, count);
+    return page.emplace(key, block).first->second;
+}
+
+Jit::Block Jit::compile(uint16_t pc, unsigned int limit)
+{
+    Block block{};
+#ifdef CHIP8_JIT_X64
+    // Pass 1: collect the block and pin every guest register it touches
+    Instr body[MAX_BLOCK_INSTRUCTIONS];
+    unsigned int count = 0;
+    unsigned int bytes = 0;
+    uint16_t regsUsed = 0;
+    bool indexUsed = false;
+    bool memoryUsed = false;
+    bool terminated = false;
+    const Quirks::Set &quirks = Quirks::Of(cpu.get_quirks());
+
+    for (unsigned int address = pc;
+         count < limit && address + 1 < cpu.memory.Size() && !terminated;
+         address += 2)
+    {
+        Instr in = Processor::decode((cpu.memory[address] << 8u) | cpu.memory[address + 1]);
+        uint16_t regs;
+        bool usesIndex;
+        bool usesMemory;
+        if (!footprint(in, quirks, regs, usesIndex, usesMemory, terminated))
+            break;
+
+        // Memory access takes two pool registers: the base and an address
+        unsigned int needed = popcount16(regsUsed | regs) + ((indexUsed || usesIndex) ? 1 : 0) +
+                              ((memoryUsed || usesMemory) ? 2 : 0);
+        if (needed > POOL_SIZE || bytes + emittedBytes(in) > MAX_BLOCK_BYTES - BLOCK_FRAME_BYTES)
+            break;
+
+        regsUsed |= regs;
+        indexUsed = indexUsed || usesIndex;
+        memoryUsed = memoryUsed || usesMemory;
+        bytes += emittedBytes(in);
+        body[count++] = in;
+    }
+
+    if (count == 0)
+    {
+        block.end = pc + 2u;
+        block.count = 1;
+        block.state = State::INTERPRETED;
+        codeBytes[pc] = codeBytes[pc + 1] = 1;
+        return block;
+    }
+
+    // Out of space: drop everything and start over with this block
+    if (codeUsed + MAX_BLOCK_BYTES > CODE_BUFFER_BYTES)
+        flush();
+
+    block.end = pc + 2 * count;
+    for (unsigned int a = pc; a < block.end; ++a)
+        codeBytes[a] = 1;
+
+    int host[N_REGISTERS];
+    unsigned int next = 0;
+    for (unsigned int v = 0; v < N_REGISTERS; ++v)
+        host[v] = (regsUsed & (1u << v)) ? POOL[next++] : -1;
+    int indexHost = indexUsed ? POOL[next++] : -1;
+    const int memBase = memoryUsed ? POOL[next++] : -1;
+    const int memAddress = memoryUsed ? POOL[next++] : -1;
+    auto displacement = [this](const void *field)
+    {
+        return static_cast<int32_t>(static_cast<const uint8_t *>(field) - cpu.registers);
+    };
+    const int32_t indexDisp = displacement(&cpu.index);
+    const int32_t delayDisp = displacement(&cpu.delay_timer);
+    const int32_t soundDisp = displacement(&cpu.sound_timer);
+    const int32_t stackDisp = displacement(cpu.stack);
+    const int32_t spDisp = displacement(&cpu.stack_pointer);
+    const uint32_t memBytes = Quirks::MemoryBytes(quirks);
+    const int F = host[0xF];
+
+    // Pass 2: emit
+    mprotect(code, CODE_BUFFER_BYTES, PROT_READ | PROT_WRITE);
+    uint8_t *entry = code + codeUsed;
+    Emitter e(entry);
+    uint16_t dirty = 0;
+    bool indexDirty = false;
+    uint8_t stored = 0;
+    uint8_t storeRewind = 0;
+
+    for (unsigned int i = 0; i < next; ++i)
+    {
+        if (calleeSaved(POOL[i]))
+            e.push(POOL[i]);
+    }
+    if (memoryUsed && memBase != RSI)
+        e.alu64(0x89, memBase, RSI);
+    for (unsigned int v = 0; v < N_REGISTERS; ++v)
+    {
+        if (host[v] >= 0)
+            e.loadByte(host[v], static_cast<int32_t>(v));
+    }
+    if (indexHost >= 0)
+        e.loadWord(indexHost, indexDisp);
+
+    auto epilogue = [&]()
+    {
+        // Stores and pops leave the flags alone, so a pending compare survives
+        for (unsigned int v = 0; v < N_REGISTERS; ++v)
+        {
+            if (dirty & (1u << v))
+                e.storeByte(host[v], static_cast<int32_t>(v));
+        }
+        if (indexDirty)
+            e.storeWord(indexHost, indexDisp);
+        for (unsigned int i = next; i-- > 0;)
+        {
+            if (calleeSaved(POOL[i]))
+                e.pop(POOL[i]);
+        }
+    };
+
+    // Byte I + offset of guest memory, if it is inside the profile's
+    // memory, to or from host register r; anything past it is dropped
+    auto accessMemory = [&](bool store, int r, unsigned int offset)
+    {
+        e.alu(0x89, memAddress, indexHost);
+        if (offset)
+            e.aluImm(0, memAddress, offset);
+        e.aluImm(7, memAddress, memBytes);
+        uint8_t *outside = e.jump(CC_AE);
+        e.alu64(0x01, memAddress, memBase);
+        if (store)
+            e.storeByteAt(r, memAddress);
+        else
+            e.loadByteAt(r, memAddress);
+        e.bind(outside);
+    };
+
+    uint32_t address = pc;
+    bool exited = false;
+
+    for (unsigned int i = 0; i < count; ++i, address += 2)
+    {
+        const Instr &in = body[i];
+        const int X = host[in.x], Y = host[in.y];
+
+        switch (in.op)
+        {
+        case Op::OP_6xnn:
+            e.movImm(X, in.nn);
+            dirty |= 1u << in.x;
+            break;
+        case Op::OP_7xnn:
+            e.aluImm(0, X, in.nn);
+            e.aluImm(4, X, 0xFF);
+            dirty |= 1u << in.x;
+            break;
+        case Op::OP_8xy0:
+            e.alu(0x89, X, Y);
+            dirty |= 1u << in.x;
+            break;
+        case Op::OP_8xy1:
+            e.alu(0x09, X, Y);
+            dirty |= 1u << in.x;
+            if (quirks.logicResetsVf)
+            {
+                e.movImm(F, 0);
+                dirty |= 1u << 0xF;
+            }
+            break;
+        case Op::OP_8xy2:
+            e.alu(0x21, X, Y);
+            dirty |= 1u << in.x;
+            if (quirks.logicResetsVf)
+            {
+                e.movImm(F, 0);
+                dirty |= 1u << 0xF;
+            }
+            break;
+        case Op::OP_8xy3:
+            e.alu(0x31, X, Y);
+            dirty |= 1u << in.x;
+            if (quirks.logicResetsVf)
+            {
+                e.movImm(F, 0);
+                dirty |= 1u << 0xF;
+            }
+            break;
+        case Op::OP_8xy4:
+            e.alu(0x89, RAX, X);
+            e.alu(0x01, RAX, Y);
+            e.alu(0x89, F, RAX);
+            e.shift(5, F, 8);
+            e.alu(0x89, X, RAX);
+            e.aluImm(4, X, 0xFF);
+            dirty |= (1u << in.x) | (1u << 0xF);
+            break;
+        case Op::OP_8xy5:
+            e.alu(0x39, X, Y);
+            e.setccEax(CC_AE);
+            e.alu(0x89, F, RAX);
+            e.alu(0x29, X, Y);
+            e.aluImm(4, X, 0xFF);
+            dirty |= (1u << in.x) | (1u << 0xF);
+            break;
+        case Op::OP_8xy6:
+        {
+            // Without VF as an operand the source survives the flag write
+            const int S = quirks.shiftUsesVy ? Y : X;
+            e.alu(0x89, RAX, S);
+            e.aluImm(4, RAX, 1);
+            e.alu(0x89, F, RAX);
+            if (S != X)
+                e.alu(0x89, X, S);
+            e.shift(5, X, 1);
+            dirty |= (1u << in.x) | (1u << 0xF);
+            break;
+        }
+        case Op::OP_8xy7:
+            e.alu(0x39, Y, X);
+            e.setccEax(CC_AE);
+            e.alu(0x89, F, RAX);
+            e.alu(0x89, RAX, Y);
+            e.alu(0x29, RAX, X);
+            e.aluImm(4, RAX, 0xFF);
+            e.alu(0x89, X, RAX);
+            dirty |= (1u << in.x) | (1u << 0xF);
+            break;
+        case Op::OP_8xyE:
+        {
+            const int S = quirks.shiftUsesVy ? Y : X;
+            e.alu(0x89, RAX, S);
+            e.shift(5, RAX, 7);
+            e.alu(0x89, F, RAX);
+            if (S != X)
+                e.alu(0x89, X, S);
+            e.shift(4, X, 1);
+            e.aluImm(4, X, 0xFF);
+            dirty |= (1u << in.x) | (1u << 0xF);
+            break;
+        }
+        case Op::OP_Annn:
+            e.movImm(indexHost, in.nnn);
+            indexDirty = true;
+            break;
+        case Op::OP_Fx1e:
+            e.alu(0x89, RAX, indexHost);
+            e.alu(0x01, RAX, X);
+            e.aluImm(7, RAX, Quirks::MemoryBytes(quirks));
+            e.cmov(CC_B, indexHost, RAX);
+            indexDirty = true;
+            break;
+        case Op::OP_Fx07:
+            e.loadByte(X, delayDisp);
+            dirty |= 1u << in.x;
+            break;
+        case Op::OP_Fx15:
+            e.storeByte(X, delayDisp);
+            break;
+        case Op::OP_Fx18:
+            e.storeByte(X, soundDisp);
+            break;
+        case Op::OP_Fx33:
+            // Quotients by 100 and 10 as multiply and shift, exact for a byte
+            e.imulImm(RAX, X, 41);
+            e.shift(5, RAX, 12);
+            accessMemory(true, RAX, 0);
+            e.imulImm(RAX, X, 205);
+            e.shift(5, RAX, 11);
+            e.imulImm(memAddress, X, 41);
+            e.shift(5, memAddress, 12);
+            e.imulImm(memAddress, memAddress, 10);
+            e.alu(0x29, RAX, memAddress);
+            accessMemory(true, RAX, 1);
+            e.imulImm(RAX, X, 205);
+            e.shift(5, RAX, 11);
+            e.imulImm(RAX, RAX, 10);
+            e.alu(0x89, memAddress, X);
+            e.alu(0x29, memAddress, RAX);
+            e.alu(0x89, RAX, memAddress);
+            accessMemory(true, RAX, 2);
+            epilogue();
+            e.movImm(RAX, address + 2);
+            e.ret();
+            exited = true;
+            stored = 3;
+            break;
+        case Op::OP_Fx55:
+            for (unsigned int r = 0; r <= in.x; ++r)
+            {
+                int value = host[r];
+                if (value < 0)
+                {
+                    e.loadByte(RAX, static_cast<int32_t>(r));
+                    value = RAX;
+                }
+                accessMemory(true, value, r);
+            }
+            stored = in.x + 1u;
+            if (quirks.memoryAdvancesI)
+            {
+                e.aluImm(0, indexHost, in.x + 1u);
+                e.aluImm(4, indexHost, 0xFFFF);
+                indexDirty = true;
+                storeRewind = in.x + 1u;
+            }
+            epilogue();
+            e.movImm(RAX, address + 2);
+            e.ret();
+            exited = true;
+            break;
+        case Op::OP_Fx65:
+            for (unsigned int r = 0; r <= in.x; ++r)
+            {
+                if (host[r] >= 0)
+                {
+                    accessMemory(false, host[r], r);
+                    dirty |= 1u << r;
+                }
+                else
+                {
+                    // Unpinned registers are loaded through rax; a byte
+                    // outside memory leaves the register as it was
+                    e.loadByte(RAX, static_cast<int32_t>(r));
+                    accessMemory(false, RAX, r);
+                    e.storeByte(RAX, static_cast<int32_t>(r));
+                }
+            }
+            if (quirks.memoryAdvancesI)
+            {
+                e.aluImm(0, indexHost, in.x + 1u);
+                e.aluImm(4, indexHost, 0xFFFF);
+                indexDirty = true;
+            }
+            break;
+        case Op::OP_2nnn:
+        {
+            // A full stack makes the call a no-op, as in the interpreter
+            epilogue();
+            e.loadByte(RAX, spDisp);
+            e.aluImm(7, RAX, STACK_SIZE);
+            uint8_t *full = e.jump(CC_AE);
+            e.storeStackSlot(static_cast<uint16_t>(address + 2), stackDisp);
+            e.aluImm(0, RAX, 1);
+            e.storeByte(RAX, spDisp);
+            e.movImm(RAX, in.nnn);
+            e.ret();
+            e.bind(full);
+            e.movImm(RAX, address + 2);
+            e.ret();
+            exited = true;
+            break;
+        }
+        case Op::OP_00EE:
+        {
+            // So does a return with nothing on the stack
+            epilogue();
+            e.loadByte(RAX, spDisp);
+            e.aluImm(5, RAX, 1);
+            uint8_t *empty = e.jump(CC_B);
+            e.storeByte(RAX, spDisp);
+            e.loadStackSlot(RAX, stackDisp);
+            e.ret();
+            e.bind(empty);
+            e.movImm(RAX, address + 2);
+            e.ret();
+            exited = true;
+            break;
+        }
+        case Op::OP_1nnn:
+            epilogue();
+            e.movImm(RAX, in.nnn);
+            e.ret();
+            exited = true;
+            break;
+        case Op::OP_Bnnn:
+            e.alu(0x89, RAX, host[quirks.jumpUsesVx ? in.x : 0]);
+            e.aluImm(0, RAX, in.nnn);
+            epilogue();
+            e.ret();
+            exited = true;
+            break;
+        case Op::OP_3xnn:
+        case Op::OP_4xnn:
+        case Op::OP_5xy0:
+        case Op::OP_9xy0:
+        {
+            if (in.op == Op::OP_3xnn || in.op == Op::OP_4xnn)
+                e.aluImm(7, X, in.nn);
+            else
+                e.alu(0x39, X, Y);
+            bool skipIfEqual = in.op == Op::OP_3xnn || in.op == Op::OP_5xy0;
+            epilogue();
+            e.movImm(RAX, address + 2);
+            e.movImm(RCX, address + 4);
+            e.cmov(skipIfEqual ? CC_E : CC_NE, RAX, RCX);
+            e.ret();
+            exited = true;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    if (!exited)
+    {
+        epilogue();
+        e.movImm(RAX, address);
+        e.ret();
+    }
+
+    mprotect(code, CODE_BUFFER_BYTES, PROT_READ | PROT_EXEC);
+    codeUsed += (e.size() + 15) & ~static_cast<size_t>(15);
+
+    block.entry = reinterpret_cast<BlockFn>(entry);
+    block.count = static_cast<uint8_t>(count);
+    block.state = State::NATIVE;
+    block.stored = stored;
+    block.storeRewind = storeRewind;
+#else
+    (void)limit;
+    block.end = pc + 2u;
+    block.count = 1;
+    block.state = State::INTERPRETED;
+#endif
+    return block;
+}
+
+void Jit::invalidate(unsigned int first, unsigned int last)
+{
+    const unsigned int reach = 2 * MAX_BLOCK_INSTRUCTIONS;
+    last = std::min<unsigned int>(last, MEM_SIZE_BYTES - 1);
+
+    bool stale = false;
+    for (unsigned int a = first; a <= last; ++a)
+    {
+        if (!codeBytes[a])
+            continue;
+        stale = true;
+
+        for (unsigned int s = a >= reach ? a - reach + 1 : 0; s <= a; ++s)
+        {
+            if (blocks[s].state != State::EMPTY && a < blocks[s].end)
+                blocks[s].state = State::EMPTY;
+        }
+    }
+    if (!stale)
+        return;
+
+    // A partial starts less than `reach` bytes before any byte it covers,
+    // so only the pages from there to `last` can hold one that overlaps
+    unsigned int from = first >= reach ? first - reach + 1 : 0;
+    for (unsigned int p = from >> PAGE_BITS; p <= last >> PAGE_BITS; ++p)
+    {
+        for (auto it = partials[p].begin(); it != partials[p].end();)
+        {
+            uint16_t start = static_cast<uint16_t>(it->first >> 8);
+            if (start <= last && first < it->second.end)
+                it = partials[p].erase(it);
+            else
+                ++it;
+        }
+    }
+}
+
+// A native store ends its block, so the bookkeeping note_store does in the
+// interpreter happens here, before anything else is looked up
+void Jit::note_store(uint16_t first, unsigned int count)
+{
+    ++cpu.side_effects;
+    cpu.memory.NoteWritten(first, first + count);
+    invalidate(first, first + count - 1u);
+}
+
+template <Quirks::Profile P>
+void Jit::interpret()
+{
+    // One fetch, and a direct call into the profile's handlers
+    Instr in = cpu.fetch();
+    uint16_t index = cpu.index;
+    CHIP8_PROFILE_INSTRUCTION(in.op, cpu.pc);
+    cpu.pc += 2;
+    cpu.execute<P>(in);
+
+    // Stores the translator leaves to the interpreter
+    if (in.op == Op::OP_Fx33)
+        invalidate(index, index + 2u);
+    else if (in.op == Op::OP_Fx55)
+        invalidate(index, index + in.x);
+    else if (in.op == Op::OP_5xy2)
+        invalidate(index, index + (in.x > in.y ? in.x - in.y : in.y - in.x));
+}
+
+RunResult Jit::run(uint64_t cycles)
+{
+    // Native blocks would leave holes in the trace
+    if (cpu.is_traced())
+        return cpu.run(cycles);
+
+    RunResult result{Exit::BUDGET, cycles};
+
+    // Blocks bake in the quirks they were translated under
+    if (cpu.get_quirks() != quirks)
+    {
+        flush();
+        quirks = cpu.get_quirks();
+    }
+
+    using Quirks::Profile;
+    static const ExecuteFn EXECUTORS[] = {
+        &Jit::execute<Profile::MODERN>,
+        &Jit::execute<Profile::CHIP8>,
+        &Jit::execute<Profile::SCHIP>,
+        &Jit::execute<Profile::XOCHIP>,
+    };
+    static_assert(sizeof(EXECUTORS) / sizeof(EXECUTORS[0]) == static_cast<size_t>(Profile::COUNT),
+                  "EXECUTORS must cover every Profile");
+    const ExecuteFn execute = EXECUTORS[static_cast<size_t>(quirks)];
+
+    // Same emulated-time bookkeeping as Processor::run: translated code never
+    // crosses a frame boundary, so the timers tick exactly where the
+    // interpreter would tick them.
+    cpu.idle_reset();
+    while (cycles > 0)
+    {
+        cpu.start_frame();
+        uint64_t slice = cycles < cpu.frame_left ? cycles : cpu.frame_left;
+
+        result.idle_cycles += (this->*execute)(slice);
+        cycles -= slice;
+        cpu.frame_left -= slice;
+        if (cpu.frame_left == 0)
+            cpu.tick_timers();
+    }
+    cpu.executed += result.cycles;
+    return result;
+}
+
+template <Quirks::Profile P>
+uint64_t Jit::execute(uint64_t cycles)
+{
+    uint64_t total = cycles;
+    uint64_t skipped = 0;
+
+    while (cycles > 0)
+    {
+        uint16_t before = cpu.pc;
+        bool native = false;
+
+        if (code)
+        {
+            Block *block = &lookup(cpu.pc);
+
+            // A block longer than the remaining budget (e.g. the rest of a
+            // 60 Hz tick) runs as a shorter variant cut to fit exactly
+            if (block->state == State::NATIVE && block->count > cycles)
+                block = &lookupPartial(cpu.pc, static_cast<unsigned int>(cycles));
+
+            if (block->state == State::NATIVE)
+            {
+                cpu.pc = static_cast<uint16_t>(block->entry(cpu.registers, cpu.memory.Bytes()));
+                cycles -= block->count;
+                native = true;
+                if (block->stored)
+                    note_store(static_cast<uint16_t>(cpu.index - block->storeRewind), block->stored);
+            }
+        }
+
+        if (!native)
+        {
+            interpret<P>();
+            --cycles;
+        }
+
+        // The slice never includes the frame's tick, so it may be skipped
+        // right to its end
+        if (cpu.pc <= before && cycles > 0)
+        {
+            uint64_t idle = cpu.idle_skip(total - cycles, cycles);
+            cycles -= idle;
+            skipped += idle;
+        }
+    }
+    return skipped;
+}
@@ -0,0 +1,79 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Implements profile-sized guest memory
+ *****************************************************************************/
+
+#include "Memory.hpp"
+#include <cstring>
+
+namespace
+{
+// Storage comes in the two sizes machines address
+uint32_t storageFor(uint32_t bytes)
+{
+    return bytes <= Memory::CLASSIC_BYTES ? Memory::CLASSIC_BYTES : Memory::MAX_BYTES;
+}
+} // namespace
+
+Memory::Memory(uint32_t bytes)
+    : data(new uint8_t[storageFor(bytes)]()), capacity(storageFor(bytes)), mask(storageFor(bytes) - 1)
+{
+}
+
+Memory::Memory(const Memory &other)
+    : data(new uint8_t[other.capacity]()), capacity(other.capacity), mask(other.mask)
+{
+    *this = other;
+}
+
+Memory &Memory::operator=(const Memory &other)
+{
+    if (this == &other)
+        return *this;
+
+    if (capacity < other.capacity)
+    {
+        data.reset(new uint8_t[other.capacity]());
+        capacity = other.capacity;
+        written_first = MAX_BYTES;
+        written_end = 0;
+    }
+    Clear();
+    if (!other.Empty())
+        std::memcpy(&data[other.written_first], &other.data[other.written_first],
+                    other.written_end - other.written_first);
+    written_first = other.written_first;
+    written_end = other.written_end;
+    mask = other.mask;
+    return *this;
+}
+
+void Memory::SetSize(uint32_t bytes)
+{
+    Reserve(bytes);
+    mask = storageFor(bytes) - 1;
+}
+
+void Memory::Reserve(uint32_t bytes)
+{
+    if (bytes <= capacity)
+        return;
+
+    uint32_t grown = storageFor(bytes);
+    std::unique_ptr<uint8_t[]> larger(new uint8_t[grown]());
+    if (!Empty())
+        std::memcpy(&larger[written_first], &data[written_first], written_end - written_first);
+    data = std::move(larger);
+    capacity = grown;
+}
+
+void Memory::Clear()
+{
+    if (!Empty())
+        std::memset(&data[written_first], 0, written_end - written_first);
+    written_first = MAX_BYTES;
+    written_end = 0;
+}
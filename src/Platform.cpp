@@ -11,7 +11,7 @@
 #include <stdexcept>
 
 Platform::Platform(const char *title, int windowWidth, int windowHeight,
-                   int textureWidth, int textureHeight)
+                   int textureWidth, int textureHeight, bool vsync)
     : windowWidth(windowWidth), windowHeight(windowHeight),
       textureWidth(textureWidth), textureHeight(textureHeight)
 {
@@ -38,7 +38,11 @@ Platform::Platform(const char *title, int windowWidth, int windowHeight,
         throw std::runtime_error(msg);
     }
 
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED;
+    if (vsync)
+        rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+
+    renderer = SDL_CreateRenderer(window, -1, rendererFlags);
     if (!renderer)
     {
         std::string msg = "SDL_CreateRenderer failed: ";
@@ -48,6 +52,12 @@ Platform::Platform(const char *title, int windowWidth, int windowHeight,
         throw std::runtime_error(msg);
     }
 
+    // Drivers are free to ignore the vsync request; the caller must know so
+    // it does not spin on presents that return immediately
+    SDL_RendererInfo info;
+    if (vsync && SDL_GetRendererInfo(renderer, &info) == 0)
+        this->vsync = (info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+
     texture = SDL_CreateTexture(renderer,
                                 SDL_PIXELFORMAT_RGBA32,
                                 SDL_TEXTUREACCESS_STREAMING,
@@ -65,6 +75,7 @@ Platform::Platform(const char *title, int windowWidth, int windowHeight,
 
 Platform::~Platform()
 {
+    CloseAudio();
     if (texture)
         SDL_DestroyTexture(texture);
     if (renderer)
@@ -74,12 +85,111 @@ Platform::~Platform()
     SDL_Quit();
 }
 
-void Platform::Update(const void *buffer, int pitch)
+bool Platform::OpenAudio(AudioStream &stream, AudioStream::Options options)
+{
+    CloseAudio();
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
+    {
+        std::cerr << "Audio unavailable: " << SDL_GetError() << "\n";
+        return false;
+    }
+
+    SDL_AudioSpec desired{};
+    desired.freq = options.sampleRate;
+    desired.format = AUDIO_S16SYS;
+    desired.channels = 1;
+    desired.samples = static_cast<Uint16>(options.bufferSamples);
+    desired.callback = AudioCallback;
+    desired.userdata = &stream;
+
+    SDL_AudioSpec obtained{};
+    audioDevice = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (audioDevice == 0)
+    {
+        std::cerr << "Audio unavailable: " << SDL_GetError() << "\n";
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+
+    // The callback has not run yet: the device starts paused
+    options.sampleRate = obtained.freq;
+    options.bufferSamples = obtained.samples;
+    stream.Open(options);
+    SDL_PauseAudioDevice(audioDevice, 0);
+    return true;
+}
+
+void Platform::CloseAudio()
+{
+    if (audioDevice == 0)
+        return;
+    // Returns once the callback has finished for good
+    SDL_CloseAudioDevice(audioDevice);
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    audioDevice = 0;
+}
+
+// Runs on SDL's audio thread
+void Platform::AudioCallback(void *userdata, Uint8 *stream, int len)
+{
+    static_cast<AudioStream *>(userdata)->Render(reinterpret_cast<int16_t *>(stream),
+                                                 static_cast<size_t>(len) / sizeof(int16_t));
+}
+
+void Platform::Update(const void *buffer, int pitch, uint64_t dirtyRows)
+{
+    const auto *pixels = static_cast<const uint8_t *>(buffer);
+
+    // Upload each run of consecutive dirty rows with a single call
+    int y = 0;
+    while (y < textureHeight)
+    {
+        if (!((dirtyRows >> y) & 1u))
+        {
+            ++y;
+            continue;
+        }
+
+        int first = y;
+        while (y < textureHeight && ((dirtyRows >> y) & 1u))
+            ++y;
+
+        SDL_Rect rows{0, first, textureWidth, y - first};
+        SDL_UpdateTexture(texture, &rows, pixels + first * pitch, pitch);
+    }
+
+    Present();
+}
+
+void Platform::SetTextureSize(int width, int height)
+{
+    if (width == textureWidth && height == textureHeight)
+        return;
+
+    SDL_Texture *resized = SDL_CreateTexture(renderer,
+                                             SDL_PIXELFORMAT_RGBA32,
+                                             SDL_TEXTUREACCESS_STREAMING,
+                                             width, height);
+    if (!resized)
+        throw std::runtime_error(std::string("SDL_CreateTexture failed: ") + SDL_GetError());
+
+    SDL_DestroyTexture(texture);
+    texture = resized;
+    textureWidth = width;
+    textureHeight = height;
+}
+
+void Platform::Present()
 {
-    SDL_UpdateTexture(texture, nullptr, buffer, pitch);
     SDL_RenderClear(renderer);
     SDL_RenderCopy(renderer, texture, nullptr, nullptr);
     SDL_RenderPresent(renderer);
+
+    if (inputPending)
+    {
+        inputLatency.Add(std::chrono::duration<double, std::milli>(Clock::now() - inputArrival).count());
+        inputPending = false;
+    }
 }
 
 bool Platform::ProcessInput(uint8_t *keys)
@@ -87,6 +197,36 @@ bool Platform::ProcessInput(uint8_t *keys)
     bool quit = false;
     SDL_Event event;
 
+    while (SDL_PollEvent(&event))
+        quit |= HandleEvent(event, keys);
+
+    return quit;
+}
+
+bool Platform::WaitInput(uint8_t *keys, int timeoutMs)
+{
+    if (timeoutMs <= 0)
+        return ProcessInput(keys);
+
+    bool quit = false;
+    SDL_Event event;
+
+    if (SDL_WaitEventTimeout(&event, timeoutMs))
+        quit = HandleEvent(event, keys);
+
+    return ProcessInput(keys) || quit;
+}
+
+void Platform::Wake()
+{
+    // The event carries nothing; HandleEvent ignores its type
+    SDL_Event event{};
+    event.type = SDL_USEREVENT;
+    SDL_PushEvent(&event);
+}
+
+bool Platform::HandleEvent(const SDL_Event &event, uint8_t *keys)
+{
     static constexpr struct
     {
         SDL_Keycode key;
@@ -95,37 +235,53 @@ bool Platform::ProcessInput(uint8_t *keys)
         {
             {SDLK_x, 0x0}, {SDLK_1, 0x1}, {SDLK_2, 0x2}, {SDLK_3, 0x3}, {SDLK_q, 0x4}, {SDLK_w, 0x5}, {SDLK_e, 0x6}, {SDLK_a, 0x7}, {SDLK_s, 0x8}, {SDLK_d, 0x9}, {SDLK_z, 0xA}, {SDLK_c, 0xB}, {SDLK_4, 0xC}, {SDLK_r, 0xD}, {SDLK_f, 0xE}, {SDLK_v, 0xF}};
 
-    while (SDL_PollEvent(&event))
+    switch (event.type)
+    {
+    case SDL_QUIT:
+        return true;
+
+    case SDL_WINDOWEVENT:
+        // The texture still holds the last frame; redraw it when the window
+        // contents were lost or resized, since the display has not changed.
+        // Focus, motion and the like need nothing.
+        if (event.window.event == SDL_WINDOWEVENT_EXPOSED || event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+            Present();
+        break;
+
+    case SDL_KEYDOWN:
+    case SDL_KEYUP:
     {
-        switch (event.type)
+        bool pressed = (event.type == SDL_KEYDOWN);
+
+        if (event.key.keysym.sym == SDLK_ESCAPE)
+            return true;
+
+        if (event.key.keysym.sym == SDLK_TAB)
         {
-        case SDL_QUIT:
-            quit = true;
+            turbo = pressed;
             break;
+        }
 
-        case SDL_KEYDOWN:
-        case SDL_KEYUP:
+        for (const auto &m : keyMap)
         {
-            bool pressed = (event.type == SDL_KEYDOWN);
-
-            if (event.key.keysym.sym == SDLK_ESCAPE)
+            if (event.key.keysym.sym == m.key)
             {
-                quit = true;
-                break;
-            }
+                keys[m.index] = pressed ? 1 : 0;
 
-            for (const auto &m : keyMap)
-            {
-                if (event.key.keysym.sym == m.key)
+                if (!inputPending && !event.key.repeat)
                 {
-                    keys[m.index] = pressed ? 1 : 0;
-                    break;
+                    // The event may have queued a while before we saw it;
+                    // both clocks count milliseconds since SDL_Init
+                    Uint32 queued = SDL_GetTicks() - event.key.timestamp;
+                    inputArrival = Clock::now() - std::chrono::milliseconds(queued);
+                    inputPending = true;
                 }
+                break;
             }
-            break;
-        }
         }
+        break;
+    }
     }
 
-    return quit;
+    return false;
 }
@@ -0,0 +1,815 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Implements the lockstep structure-of-arrays engine
+ *****************************************************************************/
+
+#include "ProcessorBatch.hpp"
+#include <algorithm>
+#include <cstring>
+
+// On x86-64 Linux the group kernels are built twice, for AVX2 and for the
+// baseline SSE2, and the loader picks the one the CPU supports
+#if defined(__x86_64__) && defined(__linux__) && defined(__GNUC__)
+#define CHIP8_LANE_KERNEL __attribute__((target_clones("avx2", "default")))
+#else
+#define CHIP8_LANE_KERNEL
+#endif
+
+// The helpers below pass 32-byte vectors by value. They are internal and
+// inlined, so the ABI note GCC gives for that without -mavx does not apply.
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace
+{
+// Rows of the [field][lane] arrays sit `stride` elements apart. A large
+// power-of-two row pitch maps every row onto the same few cache sets, so
+// such strides get one more block of padding.
+unsigned int laneStride(unsigned int lanes)
+{
+    unsigned int block = ProcessorBatch::LANE_BLOCK;
+    unsigned int stride = (lanes + block - 1) / block * block;
+    if (stride % (8 * block) == 0)
+        stride += block;
+    return stride;
+}
+
+// GCC/Clang vector extensions: each value holds one field for a run of lanes
+typedef uint8_t U8x32 __attribute__((vector_size(32)));
+typedef uint8_t U8x16 __attribute__((vector_size(16)));
+typedef int8_t I8x16 __attribute__((vector_size(16)));
+typedef uint16_t U16x16 __attribute__((vector_size(32)));
+typedef int16_t I16x16 __attribute__((vector_size(32)));
+
+static_assert(ProcessorBatch::LANE_BLOCK == 32, "kernels assume 32-lane blocks");
+
+template <typename V, typename T>
+inline V load(const T *p)
+{
+    V v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+template <typename V, typename T>
+inline void store(T *p, const V &v)
+{
+    std::memcpy(p, &v, sizeof(v));
+}
+
+// Lane masks are 0x00 or 0xFF per lane
+inline U8x32 blend(const U8x32 &mask, const U8x32 &a, const U8x32 &b)
+{
+    return (a & mask) | (b & ~mask);
+}
+
+inline U16x16 blend(const U16x16 &mask, const U16x16 &a, const U16x16 &b)
+{
+    return (a & mask) | (b & ~mask);
+}
+
+// 16 lanes of a byte mask widened to 16-bit lanes
+inline U16x16 widenMask(const uint8_t *mask)
+{
+    return (U16x16)__builtin_convertvector(load<I8x16>(mask), I16x16);
+}
+
+inline U16x16 widen(const uint8_t *bytes)
+{
+    return __builtin_convertvector(load<U8x16>(bytes), U16x16);
+}
+
+// Row of the display array holding plane p, pixel row y, word w
+inline unsigned int displayRow(unsigned int p, unsigned int y, unsigned int w)
+{
+    return (p * HIRES_HEIGHT + y) * ROW_WORDS + w;
+}
+const unsigned int DISPLAY_ROWS = DISPLAY_PLANES * HIRES_HEIGHT * ROW_WORDS;
+} // namespace
+
+ProcessorBatch::ProcessorBatch(unsigned int lanes)
+    : lanes(lanes),
+      stride(laneStride(lanes)),
+      registers(N_REGISTERS * stride),
+      memory(Memory::CLASSIC_BYTES * stride),
+      index(stride),
+      pc(stride),
+      stack(STACK_SIZE * stride),
+      stack_pointer(stride),
+      delay_timer(stride),
+      sound_timer(stride),
+      keypad(NUM_KEYS * stride),
+      display(DISPLAY_ROWS * stride),
+      generation(stride),
+      dirty_rows(stride),
+      rng(stride),
+      hires(stride),
+      planes(stride),
+      flags(N_REGISTERS * stride),
+      audio_pattern(AUDIO_PATTERN_BYTES * stride),
+      pitch(stride),
+      pending(stride),
+      group(stride)
+{
+    broadcast(Processor());
+    seed_random(Random::EntropySeed());
+}
+
+// Puts every lane in cpu's state a row at a time; load_lane's per-lane
+// column walk would touch every memory row once per lane. Padding lanes
+// stay zeroed and are never scheduled.
+void ProcessorBatch::broadcast(const Processor &cpu)
+{
+    reserve_memory(cpu.memory.WrittenEnd());
+    for (unsigned int r = 0; r < N_REGISTERS; ++r)
+        std::memset(row(registers, r), cpu.registers[r], lanes);
+    for (unsigned int a = 0; a < memory_rows(); ++a)
+        std::memset(row(memory, a), a < cpu.memory.Capacity() ? cpu.memory[a] : 0, lanes);
+    for (unsigned int s = 0; s < STACK_SIZE; ++s)
+        std::fill_n(row(stack, s), lanes, cpu.stack[s]);
+    for (unsigned int k = 0; k < NUM_KEYS; ++k)
+        std::memset(row(keypad, k), cpu.keypad[k], lanes);
+    for (unsigned int p = 0; p < DISPLAY_PLANES; ++p)
+    {
+        for (unsigned int y = 0; y < HIRES_HEIGHT; ++y)
+        {
+            for (unsigned int w = 0; w < ROW_WORDS; ++w)
+                std::fill_n(row(display, displayRow(p, y, w)), lanes, cpu.display[p][y][w]);
+        }
+    }
+    for (unsigned int r = 0; r < N_REGISTERS; ++r)
+        std::memset(row(flags, r), cpu.flags[r], lanes);
+    for (unsigned int i = 0; i < AUDIO_PATTERN_BYTES; ++i)
+        std::memset(row(audio_pattern, i), cpu.audio_pattern[i], lanes);
+
+    std::fill_n(index.begin(), lanes, cpu.index);
+    std::fill_n(pc.begin(), lanes, cpu.pc);
+    std::fill_n(stack_pointer.begin(), lanes, cpu.stack_pointer);
+    std::fill_n(delay_timer.begin(), lanes, cpu.delay_timer);
+    std::fill_n(sound_timer.begin(), lanes, cpu.sound_timer);
+    std::fill_n(generation.begin(), lanes, cpu.generation);
+    std::fill_n(dirty_rows.begin(), lanes, cpu.dirty_rows);
+    std::fill_n(rng.begin(), lanes, cpu.rng);
+    std::fill_n(hires.begin(), lanes, cpu.hires);
+    std::fill_n(planes.begin(), lanes, cpu.planes);
+    std::fill_n(pitch.begin(), lanes, cpu.pitch);
+}
+
+void ProcessorBatch::seed_random(uint64_t seed, Random::Engine engine)
+{
+    for (unsigned int lane = 0; lane < lanes; ++lane)
+        rng[lane].Seed(seed + lane, engine);
+}
+
+int ProcessorBatch::load_rom(const uint8_t *data, size_t size)
+{
+    Processor probe;
+    probe.set_quirks(quirks);
+    if (probe.load_rom(data, size) != 0)
+        return 1;
+
+    reserve_memory(static_cast<unsigned int>(START_ADDRESS + size));
+    for (size_t i = 0; i < size; ++i)
+        std::memset(row(memory, START_ADDRESS + i), data[i], lanes);
+    return 0;
+}
+
+void ProcessorBatch::set_quirks(Quirks::Profile profile)
+{
+    quirks = profile;
+    reserve_memory(Quirks::MemoryBytes(Quirks::Of(profile)));
+}
+
+// Rows are added at the end, so growing keeps every lane's memory
+void ProcessorBatch::reserve_memory(unsigned int bytes)
+{
+    unsigned int rows = bytes <= Memory::CLASSIC_BYTES ? Memory::CLASSIC_BYTES : Memory::MAX_BYTES;
+    if (rows > memory_rows())
+        memory.resize(static_cast<size_t>(rows) * stride);
+}
+
+void ProcessorBatch::load_lane(unsigned int lane, const Processor &cpu)
+{
+    reserve_memory(cpu.memory.WrittenEnd());
+    for (unsigned int r = 0; r < N_REGISTERS; ++r)
+        row(registers, r)[lane] = cpu.registers[r];
+    for (unsigned int a = 0; a < memory_rows(); ++a)
+        row(memory, a)[lane] = a < cpu.memory.Capacity() ? cpu.memory[a] : 0;
+    for (unsigned int s = 0; s < STACK_SIZE; ++s)
+        row(stack, s)[lane] = cpu.stack[s];
+    for (unsigned int k = 0; k < NUM_KEYS; ++k)
+        row(keypad, k)[lane] = cpu.keypad[k];
+    for (unsigned int p = 0; p < DISPLAY_PLANES; ++p)
+    {
+        for (unsigned int y = 0; y < HIRES_HEIGHT; ++y)
+        {
+            for (unsigned int w = 0; w < ROW_WORDS; ++w)
+                row(display, displayRow(p, y, w))[lane] = cpu.display[p][y][w];
+        }
+    }
+    for (unsigned int r = 0; r < N_REGISTERS; ++r)
+        row(flags, r)[lane] = cpu.flags[r];
+    for (unsigned int i = 0; i < AUDIO_PATTERN_BYTES; ++i)
+        row(audio_pattern, i)[lane] = cpu.audio_pattern[i];
+
+    index[lane] = cpu.index;
+    pc[lane] = cpu.pc;
+    stack_pointer[lane] = cpu.stack_pointer;
+    delay_timer[lane] = cpu.delay_timer;
+    sound_timer[lane] = cpu.sound_timer;
+    generation[lane] = cpu.generation;
+    dirty_rows[lane] = cpu.dirty_rows;
+    rng[lane] = cpu.rng;
+    hires[lane] = cpu.hires;
+    planes[lane] = cpu.planes;
+    pitch[lane] = cpu.pitch;
+}
+
+void ProcessorBatch::store_lane(unsigned int lane, Processor &cpu) const
+{
+    for (unsigned int r = 0; r < N_REGISTERS; ++r)
+        cpu.registers[r] = row(registers, r)[lane];
+    // Only the lane's nonzero extent is reported written, so copies of cpu
+    // stay as cheap as those of a machine that ran the ROM itself
+    cpu.memory.Clear();
+    cpu.memory.Reserve(memory_rows());
+    unsigned int first = memory_rows();
+    unsigned int end = 0;
+    for (unsigned int a = 0; a < memory_rows(); ++a)
+    {
+        uint8_t value = row(memory, a)[lane];
+        cpu.memory[a] = value;
+        if (value != 0)
+        {
+            first = std::min(first, a);
+            end = a + 1;
+        }
+    }
+    cpu.memory.NoteWritten(first, end);
+    for (unsigned int s = 0; s < STACK_SIZE; ++s)
+        cpu.stack[s] = row(stack, s)[lane];
+    for (unsigned int k = 0; k < NUM_KEYS; ++k)
+        cpu.keypad[k] = row(keypad, k)[lane];
+    for (unsigned int p = 0; p < DISPLAY_PLANES; ++p)
+    {
+        for (unsigned int y = 0; y < HIRES_HEIGHT; ++y)
+        {
+            for (unsigned int w = 0; w < ROW_WORDS; ++w)
+                cpu.display[p][y][w] = row(display, displayRow(p, y, w))[lane];
+        }
+    }
+    for (unsigned int r = 0; r < N_REGISTERS; ++r)
+        cpu.flags[r] = row(flags, r)[lane];
+    for (unsigned int i = 0; i < AUDIO_PATTERN_BYTES; ++i)
+        cpu.audio_pattern[i] = row(audio_pattern, i)[lane];
+
+    cpu.index = index[lane];
+    cpu.pc = pc[lane];
+    cpu.stack_pointer = stack_pointer[lane];
+    cpu.delay_timer = delay_timer[lane];
+    cpu.sound_timer = sound_timer[lane];
+    cpu.generation = generation[lane];
+    cpu.dirty_rows = dirty_rows[lane];
+    cpu.rng = rng[lane];
+    cpu.hires = hires[lane];
+    cpu.planes = planes[lane];
+    cpu.pitch = pitch[lane];
+    cpu.set_quirks(quirks);
+    cpu.scheduler = scheduler;
+    cpu.frame_left = frame_left;
+}
+
+uint64_t ProcessorBatch::state_hash(unsigned int lane) const
+{
+    Processor cpu;
+    store_lane(lane, cpu);
+    return cpu.state_hash();
+}
+
+void ProcessorBatch::run(uint64_t cycles)
+{
+    // Same frame bookkeeping as Processor::run, shared by all lanes
+    while (cycles > 0)
+    {
+        if (frame_left == 0)
+        {
+            frame_left = scheduler.NextTickBudget();
+            if (frame_left == 0)
+            {
+                tick_timers();
+                continue;
+            }
+        }
+
+        uint64_t slice = cycles < frame_left ? cycles : frame_left;
+        for (uint64_t i = 0; i < slice; ++i)
+            step();
+
+        cycles -= slice;
+        frame_left -= slice;
+        if (frame_left == 0)
+            tick_timers();
+    }
+}
+
+void ProcessorBatch::step()
+{
+    std::memset(pending.data(), 0xFF, lanes);
+
+    unsigned int remaining = lanes;
+    unsigned int leader = 0;
+    unsigned int groups = 0;
+    const unsigned int mask = Quirks::MemoryBytes(Quirks::Of(quirks)) - 1;
+
+    while (remaining > 0)
+    {
+        while (!pending[leader])
+            ++leader;
+
+        unsigned int address = pc[leader] & mask;
+        uint16_t opcode = static_cast<uint16_t>(
+            (row(memory, address)[leader] << 8u) |
+            row(memory, (address + 1) & mask)[leader]);
+        Instr in = Processor::decode(opcode);
+
+        unsigned int members = 1;
+        if (groups < MAX_GROUPS)
+        {
+            ++groups;
+            members = build_group(leader);
+        }
+
+        if (members > 1)
+        {
+            execute_group(in);
+        }
+        else
+        {
+            pending[leader] = 0;
+            pc[leader] += 2;
+            execute_lane(leader, in);
+        }
+        remaining -= members;
+    }
+}
+
+// Collects every pending lane whose next instruction is the leader's: same
+// pc and same opcode bytes. Group members are taken off the pending list and
+// have their pc advanced unless the group is only the leader.
+CHIP8_LANE_KERNEL
+unsigned int ProcessorBatch::build_group(unsigned int leader)
+{
+    uint16_t leaderPc = pc[leader];
+    const unsigned int mask = Quirks::MemoryBytes(Quirks::Of(quirks)) - 1;
+    unsigned int address = leaderPc & mask;
+    const uint8_t *hi = row(memory, address);
+    const uint8_t *lo = row(memory, (address + 1) & mask);
+    uint8_t hiByte = hi[leader];
+    uint8_t loByte = lo[leader];
+
+    unsigned int members = 0;
+    for (unsigned int base = 0; base < stride; base += LANE_BLOCK / 2)
+    {
+        I16x16 samePc = load<U16x16>(&pc[base]) == leaderPc;
+        U8x16 mask = (U8x16)__builtin_convertvector(samePc, I8x16);
+        mask &= load<U8x16>(&pending[base]);
+        mask &= (U8x16)(load<U8x16>(&hi[base]) == hiByte);
+        mask &= (U8x16)(load<U8x16>(&lo[base]) == loByte);
+        store(&group[base], mask);
+        store(&pending[base], load<U8x16>(&pending[base]) & ~mask);
+
+        for (unsigned int l = 0; l < LANE_BLOCK / 2; ++l)
+            members += mask[l] & 1u;
+    }
+
+    if (members == 1)
+    {
+        // Put the leader back; the caller runs it on its own
+        pending[leader] = 0xFF;
+        return 1;
+    }
+
+    for (unsigned int base = 0; base < stride; base += LANE_BLOCK / 2)
+        store(&pc[base], load<U16x16>(&pc[base]) + (widenMask(&group[base]) & 2));
+    return members;
+}
+
+CHIP8_LANE_KERNEL
+void ProcessorBatch::execute_group(const Instr &in)
+{
+    uint8_t *vx = row(registers, in.x);
+    uint8_t *vy = row(registers, in.y);
+    uint8_t *vf = row(registers, 0xF);
+    const Quirks::Set &q = Quirks::Of(quirks);
+
+    // ALU ops that write VF and also read or write it as an operand depend on
+    // the order of the two writes; those stay on the scalar path
+    bool flagOperand = in.x == 0xF || in.y == 0xF;
+
+    for (unsigned int base = 0; base < stride; base += LANE_BLOCK)
+    {
+        U8x32 g = load<U8x32>(&group[base]);
+        U8x32 x = load<U8x32>(&vx[base]);
+        U8x32 y = load<U8x32>(&vy[base]);
+        U8x32 skip{};
+        bool skips = false;
+
+        switch (in.op)
+        {
+        case Op::OP_6xnn: store(&vx[base], blend(g, U8x32{} + in.nn, x)); break;
+        case Op::OP_7xnn: store(&vx[base], x + (g & in.nn)); break;
+        case Op::OP_8xy0: store(&vx[base], blend(g, y, x)); break;
+        case Op::OP_8xy1:
+        case Op::OP_8xy2:
+        case Op::OP_8xy3:
+            if (in.op == Op::OP_8xy1)
+                store(&vx[base], x | (y & g));
+            else if (in.op == Op::OP_8xy2)
+                store(&vx[base], x & (y | ~g));
+            else
+                store(&vx[base], x ^ (y & g));
+            // Reloaded, as VX may be VF
+            if (q.logicResetsVf)
+                store(&vf[base], load<U8x32>(&vf[base]) & ~g);
+            break;
+        case Op::OP_Fx07: store(&vx[base], blend(g, load<U8x32>(&delay_timer[base]), x)); break;
+        case Op::OP_Fx15: store(&delay_timer[base], blend(g, x, load<U8x32>(&delay_timer[base]))); break;
+        case Op::OP_Fx18: store(&sound_timer[base], blend(g, x, load<U8x32>(&sound_timer[base]))); break;
+
+        case Op::OP_8xy4:
+        case Op::OP_8xy5:
+        case Op::OP_8xy6:
+        case Op::OP_8xy7:
+        case Op::OP_8xyE:
+        {
+            if (flagOperand)
+                break;
+            U8x32 result;
+            U8x32 flag;
+            U8x32 source = q.shiftUsesVy ? y : x;
+            switch (in.op)
+            {
+            case Op::OP_8xy4:
+                result = x + y;
+                flag = (U8x32)(result < x) & 1;
+                break;
+            case Op::OP_8xy5:
+                result = x - y;
+                flag = (U8x32)(x >= y) & 1;
+                break;
+            case Op::OP_8xy6:
+                result = source >> 1;
+                flag = source & 1;
+                break;
+            case Op::OP_8xy7:
+                result = y - x;
+                flag = (U8x32)(y >= x) & 1;
+                break;
+            default: // OP_8xyE
+                result = source << 1;
+                flag = source >> 7;
+                break;
+            }
+            store(&vf[base], blend(g, flag, load<U8x32>(&vf[base])));
+            store(&vx[base], blend(g, result, x));
+            break;
+        }
+
+        // Long skips look at the next instruction, per lane
+        case Op::OP_3xnn: skip = (U8x32)(x == in.nn); skips = !q.longSkips; break;
+        case Op::OP_4xnn: skip = (U8x32)(x != in.nn); skips = !q.longSkips; break;
+        case Op::OP_5xy0: skip = (U8x32)(x == y); skips = !q.longSkips; break;
+        case Op::OP_9xy0: skip = (U8x32)(x != y); skips = !q.longSkips; break;
+
+        case Op::OP_1nnn:
+        case Op::OP_Bnnn:
+        case Op::OP_Annn:
+        case Op::OP_Fx1e:
+            for (unsigned int half = 0; half < LANE_BLOCK; half += LANE_BLOCK / 2)
+            {
+                unsigned int lane = base + half;
+                U16x16 g16 = widenMask(&group[lane]);
+                U16x16 pcs = load<U16x16>(&pc[lane]);
+                U16x16 indices = load<U16x16>(&index[lane]);
+                switch (in.op)
+                {
+                case Op::OP_1nnn:
+                    store(&pc[lane], blend(g16, U16x16{} + in.nnn, pcs));
+                    break;
+                case Op::OP_Bnnn:
+                    store(&pc[lane], blend(g16, widen(&row(registers, q.jumpUsesVx ? in.x : 0)[lane]) + in.nnn, pcs));
+                    break;
+                case Op::OP_Annn:
+                    store(&index[lane], blend(g16, U16x16{} + in.nnn, indices));
+                    break;
+                default: // OP_Fx1e
+                {
+                    // A sum fits when it does not wrap 16 bits and, for the
+                    // 4 KiB profiles, stays below 0x1000
+                    U16x16 sum = indices + widen(&vx[lane]);
+                    U16x16 fits = (U16x16)(sum >= indices) & g16;
+                    if (!q.bigMemory)
+                        fits &= (U16x16)(sum < static_cast<uint16_t>(Quirks::MemoryBytes(q)));
+                    store(&index[lane], blend(fits, sum, indices));
+                    break;
+                }
+                }
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        if (skips)
+        {
+            uint8_t taken[LANE_BLOCK];
+            store(taken, skip & g);
+            for (unsigned int half = 0; half < LANE_BLOCK; half += LANE_BLOCK / 2)
+            {
+                unsigned int lane = base + half;
+                store(&pc[lane], load<U16x16>(&pc[lane]) + (widenMask(&taken[half]) & 2));
+            }
+        }
+    }
+
+    bool vectorized;
+    switch (in.op)
+    {
+    case Op::OP_8xy4:
+    case Op::OP_8xy5:
+    case Op::OP_8xy6:
+    case Op::OP_8xy7:
+    case Op::OP_8xyE:
+        vectorized = !flagOperand;
+        break;
+    case Op::OP_3xnn: case Op::OP_4xnn: case Op::OP_5xy0: case Op::OP_9xy0:
+        vectorized = !q.longSkips;
+        break;
+    case Op::OP_6xnn: case Op::OP_7xnn: case Op::OP_8xy0: case Op::OP_8xy1:
+    case Op::OP_8xy2: case Op::OP_8xy3: case Op::OP_Fx07: case Op::OP_Fx15:
+    case Op::OP_Fx18: case Op::OP_1nnn: case Op::OP_Bnnn: case Op::OP_Annn:
+    case Op::OP_Fx1e:
+        vectorized = true;
+        break;
+    default:
+        vectorized = false;
+        break;
+    }
+
+    // Draws, the stack, memory, keys and random numbers run lane by lane
+    if (!vectorized)
+    {
+        for (unsigned int lane = 0; lane < lanes; ++lane)
+        {
+            if (group[lane])
+                execute_lane(lane, in);
+        }
+    }
+}
+
+// Scalar copy of the handlers in opcodes.cpp for one lane; pc has already
+// been advanced past the instruction
+void ProcessorBatch::execute_lane(unsigned int lane, const Instr &in)
+{
+    auto V = [&](unsigned int r) -> uint8_t & { return registers[r * stride + lane]; };
+    auto mem = [&](unsigned int address) -> uint8_t & { return memory[address * stride + lane]; };
+    uint16_t &I = index[lane];
+    uint16_t &PC = pc[lane];
+    uint8_t &SP = stack_pointer[lane];
+    const Quirks::Set &q = Quirks::Of(quirks);
+    const unsigned int memBytes = Quirks::MemoryBytes(q);
+    auto word = [&](unsigned int p, unsigned int y, unsigned int w) -> uint64_t &
+    { return display[displayRow(p, y, w) * stride + lane]; };
+    auto skipNext = [&]()
+    {
+        if (q.longSkips && mem(PC & (memBytes - 1)) == 0xF0 && mem((PC + 1u) & (memBytes - 1)) == 0x00)
+            PC += 2;
+        PC += 2;
+    };
+    auto displayChanged = [&]()
+    {
+        dirty_rows[lane] = ~0ull;
+        ++generation[lane];
+    };
+
+    switch (in.op)
+    {
+    case Op::OP_00E0:
+        Display::Clear(word, planes[lane]);
+        displayChanged();
+        break;
+    case Op::OP_00EE:
+        if (SP == 0)
+            break;
+        --SP;
+        PC = row(stack, SP)[lane];
+        break;
+    case Op::OP_1nnn: PC = in.nnn; break;
+    case Op::OP_2nnn:
+        if (SP >= STACK_SIZE)
+            break;
+        row(stack, SP++)[lane] = PC;
+        PC = in.nnn;
+        break;
+    case Op::OP_3xnn: if (V(in.x) == in.nn) skipNext(); break;
+    case Op::OP_4xnn: if (V(in.x) != in.nn) skipNext(); break;
+    case Op::OP_5xy0: if (V(in.x) == V(in.y)) skipNext(); break;
+    case Op::OP_6xnn: V(in.x) = in.nn; break;
+    case Op::OP_7xnn: V(in.x) += in.nn; break;
+    case Op::OP_8xy0: V(in.x) = V(in.y); break;
+    case Op::OP_8xy1: V(in.x) |= V(in.y); if (q.logicResetsVf) V(0xF) = 0; break;
+    case Op::OP_8xy2: V(in.x) &= V(in.y); if (q.logicResetsVf) V(0xF) = 0; break;
+    case Op::OP_8xy3: V(in.x) ^= V(in.y); if (q.logicResetsVf) V(0xF) = 0; break;
+    case Op::OP_8xy4:
+    {
+        uint16_t sum = V(in.x) + V(in.y);
+        V(0xF) = sum > 0xFF;
+        V(in.x) = static_cast<uint8_t>(sum);
+        break;
+    }
+    case Op::OP_8xy5:
+        V(0xF) = V(in.x) >= V(in.y);
+        V(in.x) -= V(in.y);
+        break;
+    case Op::OP_8xy6:
+    {
+        uint8_t source = V(q.shiftUsesVy ? in.y : in.x);
+        V(0xF) = source & 0x1u;
+        V(in.x) = source >> 1;
+        break;
+    }
+    case Op::OP_8xy7:
+        V(0xF) = V(in.y) >= V(in.x);
+        V(in.x) = V(in.y) - V(in.x);
+        break;
+    case Op::OP_8xyE:
+    {
+        uint8_t source = V(q.shiftUsesVy ? in.y : in.x);
+        V(0xF) = (source & 0x80u) >> 7u;
+        V(in.x) = static_cast<uint8_t>(source << 1);
+        break;
+    }
+    case Op::OP_9xy0: if (V(in.x) != V(in.y)) skipNext(); break;
+    case Op::OP_Annn: I = in.nnn; break;
+    case Op::OP_Bnnn: PC = in.nnn + V(q.jumpUsesVx ? in.x : 0); break;
+    case Op::OP_Cxnn: V(in.x) = rng[lane].NextByte() & in.nn; break;
+    case Op::OP_Dxyn:
+    {
+        V(0xF) = 0;
+        ++generation[lane];
+        if (in.n == 0 && !hires[lane] && !q.bigLoresSprites)
+            break;
+
+        auto byte = [&](unsigned int address) -> unsigned int { return mem(address); };
+        bool collided = q.spritesWrap
+            ? Display::Draw<true>(word, byte, memBytes, hires[lane], planes[lane], I,
+                                  V(in.x), V(in.y), in.n, dirty_rows[lane])
+            : Display::Draw<false>(word, byte, memBytes, hires[lane], planes[lane], I,
+                                   V(in.x), V(in.y), in.n, dirty_rows[lane]);
+        if (collided)
+            V(0xF) = 1;
+        break;
+    }
+    case Op::OP_Ex9e:
+        if (V(in.x) < NUM_KEYS && row(keypad, V(in.x))[lane])
+            skipNext();
+        break;
+    case Op::OP_Exa1:
+        if (V(in.x) < NUM_KEYS && !row(keypad, V(in.x))[lane])
+            skipNext();
+        break;
+    case Op::OP_Fx07: V(in.x) = delay_timer[lane]; break;
+    case Op::OP_Fx0a:
+    {
+        bool pressed = false;
+        for (unsigned int k = 0; k < NUM_KEYS; ++k)
+        {
+            if (row(keypad, k)[lane])
+            {
+                V(in.x) = k;
+                pressed = true;
+                break;
+            }
+        }
+        if (!pressed)
+            PC -= 2;
+        break;
+    }
+    case Op::OP_Fx15: delay_timer[lane] = V(in.x); break;
+    case Op::OP_Fx18: sound_timer[lane] = V(in.x); break;
+    case Op::OP_Fx1e:
+        if (I + V(in.x) < Quirks::MemoryBytes(q))
+            I += V(in.x);
+        break;
+    case Op::OP_Fx29:
+        if (V(in.x) < 16)
+            I = FONTSET_START_ADDRESS + 5 * V(in.x);
+        break;
+    case Op::OP_Fx33:
+    {
+        // Digits that would land past the end of memory are dropped
+        uint8_t value = V(in.x);
+        uint8_t digits[3] = {static_cast<uint8_t>(value / 100),
+                             static_cast<uint8_t>((value / 10) % 10),
+                             static_cast<uint8_t>(value % 10)};
+        for (unsigned int d = 0; d < 3; ++d)
+        {
+            if (I + d < memBytes)
+                mem(I + d) = digits[d];
+        }
+        break;
+    }
+    case Op::OP_Fx55:
+        for (unsigned int r = 0; r <= in.x; ++r)
+        {
+            if (I + r < memBytes)
+                mem(I + r) = V(r);
+        }
+        if (q.memoryAdvancesI)
+            I += in.x + 1;
+        break;
+    case Op::OP_Fx65:
+        for (unsigned int r = 0; r <= in.x; ++r)
+        {
+            if (I + r < memBytes)
+                V(r) = mem(I + r);
+        }
+        if (q.memoryAdvancesI)
+            I += in.x + 1;
+        break;
+
+    case Op::OP_00Cn:
+    case Op::OP_00Dn:
+        Display::ScrollVertical(word, hires[lane], planes[lane],
+                                in.op == Op::OP_00Cn ? in.n : -static_cast<int>(in.n));
+        displayChanged();
+        break;
+    case Op::OP_00FB:
+    case Op::OP_00FC:
+        Display::ScrollHorizontal(word, hires[lane], planes[lane], in.op == Op::OP_00FB ? 4 : -4);
+        displayChanged();
+        break;
+    case Op::OP_00FD: PC -= 2; break;
+    case Op::OP_00FE:
+    case Op::OP_00FF:
+        hires[lane] = in.op == Op::OP_00FF;
+        Display::Clear(word, (1u << DISPLAY_PLANES) - 1);
+        displayChanged();
+        break;
+    case Op::OP_Fx30:
+        if (V(in.x) < 16)
+            I = BIG_FONTSET_START_ADDRESS + 10 * V(in.x);
+        break;
+    case Op::OP_Fx75:
+        for (unsigned int r = 0; r <= in.x; ++r)
+            row(flags, r)[lane] = V(r);
+        break;
+    case Op::OP_Fx85:
+        for (unsigned int r = 0; r <= in.x; ++r)
+            V(r) = row(flags, r)[lane];
+        break;
+    case Op::OP_5xy2:
+    case Op::OP_5xy3:
+    {
+        int step = in.x <= in.y ? 1 : -1;
+        unsigned int count = (in.x <= in.y ? in.y - in.x : in.x - in.y) + 1u;
+        for (unsigned int i = 0; i < count; ++i)
+        {
+            if (I + i >= memBytes)
+                continue;
+            uint8_t &reg = V(in.x + step * static_cast<int>(i));
+            if (in.op == Op::OP_5xy2)
+                mem(I + i) = reg;
+            else
+                reg = mem(I + i);
+        }
+        break;
+    }
+    case Op::OP_F000:
+        I = static_cast<uint16_t>((mem(PC & (memBytes - 1)) << 8u) | mem((PC + 1u) & (memBytes - 1)));
+        PC += 2;
+        break;
+    case Op::OP_Fx01: planes[lane] = in.x & ((1u << DISPLAY_PLANES) - 1); break;
+    case Op::OP_F002:
+        for (unsigned int i = 0; i < AUDIO_PATTERN_BYTES; ++i)
+            row(audio_pattern, i)[lane] = mem((I + i) & (memBytes - 1));
+        break;
+    case Op::OP_Fx3a: pitch[lane] = V(in.x); break;
+    default:
+        break;
+    }
+}
+
+void ProcessorBatch::tick_timers()
+{
+    for (unsigned int base = 0; base < stride; base += LANE_BLOCK)
+    {
+        U8x32 delay = load<U8x32>(&delay_timer[base]);
+        U8x32 sound = load<U8x32>(&sound_timer[base]);
+        store(&delay_timer[base], delay - ((U8x32)(delay != 0) & 1));
+        store(&sound_timer[base], sound - ((U8x32)(sound != 0) & 1));
+    }
+}
@@ -0,0 +1,142 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Collects and prints the profiling counters
+ *****************************************************************************/
+
+#include "Profiler.hpp"
+
+#ifdef CHIP8_PROFILE
+
+#include "Disassembler.hpp"
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+const size_t HOT_PCS = 32;
+
+std::mutex registryMutex;
+std::vector<Profiler::Counters *> registry; // Never freed: counts outlive their threads
+volatile std::sig_atomic_t reportRequested = 0;
+
+void printAtExit()
+{
+    Profiler::Report(std::cerr);
+}
+
+#ifdef SIGUSR1
+extern "C" void onReportSignal(int)
+{
+    reportRequested = 1;
+}
+#endif
+
+double percent(uint64_t part, uint64_t whole)
+{
+    return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+} // namespace
+
+Profiler::Counters &Profiler::Local()
+{
+    thread_local Counters *local = nullptr;
+    if (!local)
+    {
+        local = new Counters();
+        std::lock_guard<std::mutex> lock(registryMutex);
+        if (registry.empty())
+        {
+            std::atexit(printAtExit);
+#ifdef SIGUSR1
+            std::signal(SIGUSR1, onReportSignal);
+#endif
+        }
+        registry.push_back(local);
+    }
+    return *local;
+}
+
+void Profiler::Poll()
+{
+    if (reportRequested)
+    {
+        reportRequested = 0;
+        Report(std::cerr);
+    }
+}
+
+void Profiler::Report(std::ostream &out)
+{
+    uint64_t ops[static_cast<size_t>(Op::COUNT)] = {};
+    std::vector<uint64_t> pcs(MEM_SIZE_BYTES);
+    uint64_t keyWaits = 0;
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const Counters *c : registry)
+        {
+            for (size_t i = 0; i < static_cast<size_t>(Op::COUNT); ++i)
+                ops[i] += c->ops[i].load(std::memory_order_relaxed);
+            for (size_t a = 0; a < MEM_SIZE_BYTES; ++a)
+                pcs[a] += c->pcs[a].load(std::memory_order_relaxed);
+            keyWaits += c->keyWaits.load(std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t total = 0;
+    for (uint64_t n : ops)
+        total += n;
+
+    char line[96];
+    out << "==== CHIP-8 profile ====\n";
+    std::snprintf(line, sizeof(line), "instructions    %14llu\nkey-wait cycles %14llu %6.2f%%\n",
+                  static_cast<unsigned long long>(total),
+                  static_cast<unsigned long long>(keyWaits), percent(keyWaits, total));
+    out << line;
+
+    std::vector<size_t> order;
+    for (size_t i = 0; i < static_cast<size_t>(Op::COUNT); ++i)
+    {
+        if (ops[i])
+            order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+              { return ops[a] > ops[b]; });
+
+    out << "---- by handler ----\n";
+    for (size_t i : order)
+    {
+        std::snprintf(line, sizeof(line), "%-10s %14llu %6.2f%%\n", Disassembler::OpName(static_cast<Op>(i)),
+                      static_cast<unsigned long long>(ops[i]), percent(ops[i], total));
+        out << line;
+    }
+
+    order.clear();
+    for (size_t a = 0; a < MEM_SIZE_BYTES; ++a)
+    {
+        if (pcs[a])
+            order.push_back(a);
+    }
+    size_t shown = std::min(order.size(), HOT_PCS);
+    std::partial_sort(order.begin(), order.begin() + shown, order.end(), [&](size_t a, size_t b)
+                      { return pcs[a] > pcs[b]; });
+
+    out << "---- hottest addresses ----\n";
+    for (size_t i = 0; i < shown; ++i)
+    {
+        size_t a = order[i];
+        std::snprintf(line, sizeof(line), "0x%04zx     %14llu %6.2f%%\n", a,
+                      static_cast<unsigned long long>(pcs[a]), percent(pcs[a], total));
+        out << line;
+    }
+    out.flush();
+}
+
+#endif
@@ -0,0 +1,72 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Picks and names quirk profiles
+ *****************************************************************************/
+
+#include "Quirks.hpp"
+#include <cstring>
+
+namespace
+{
+const char *const NAMES[] = {"modern", "chip8", "schip", "xochip"};
+static_assert(sizeof(NAMES) / sizeof(NAMES[0]) == static_cast<size_t>(Quirks::Profile::COUNT),
+              "NAMES must list every Profile");
+
+bool isXoChip(uint16_t op)
+{
+    // F000 NNNN (long I), F002 (audio pattern), FN01 (plane), 5XY2/5XY3
+    // (register ranges), F03A (pitch), 00DN (scroll up)
+    return op == 0xF000 || op == 0xF002 || (op & 0xF0FF) == 0xF001 ||
+           (op & 0xF00E) == 0x5002 || op == 0xF03A || (op & 0xFFF0) == 0x00D0;
+}
+
+bool isSuperChip(uint16_t op)
+{
+    // 00CN, 00FB..00FF (scroll, exit, resolution), FX30 (big font),
+    // FX75/FX85 (flag registers)
+    return ((op & 0xFFF0) == 0x00C0 && (op & 0xF)) || (op >= 0x00FB && op <= 0x00FF) ||
+           (op & 0xF0FF) == 0xF030 || (op & 0xF0FF) == 0xF075 || (op & 0xF0FF) == 0xF085;
+}
+} // namespace
+
+Quirks::Profile Quirks::Detect(const uint8_t *rom, size_t size)
+{
+    // Code and data are not told apart, so each family needs two hits
+    // before a stray data word can change the verdict
+    unsigned int xo = 0;
+    unsigned int super = 0;
+    for (size_t i = 0; i + 1 < size; i += 2)
+    {
+        uint16_t op = static_cast<uint16_t>((rom[i] << 8u) | rom[i + 1]);
+        xo += isXoChip(op);
+        super += isSuperChip(op);
+    }
+
+    if (xo >= 2)
+        return Profile::XOCHIP;
+    if (super >= 2)
+        return Profile::SCHIP;
+    return Profile::MODERN;
+}
+
+const char *Quirks::Name(Profile profile)
+{
+    size_t i = static_cast<size_t>(profile);
+    return i < static_cast<size_t>(Profile::COUNT) ? NAMES[i] : "unknown";
+}
+
+bool Quirks::Parse(const char *name, Profile &profile)
+{
+    for (size_t i = 0; i < static_cast<size_t>(Profile::COUNT); ++i)
+    {
+        if (std::strcmp(name, NAMES[i]) == 0)
+        {
+            profile = static_cast<Profile>(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,38 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Seeding helpers for the random engines
+ *****************************************************************************/
+
+#include "Random.hpp"
+#include <atomic>
+#include <cstring>
+#include <random>
+
+uint64_t Random::EntropySeed()
+{
+    // The OS is asked once per process; each call then takes the next value
+    // of a SplitMix64 sequence from there, so constructing a machine makes
+    // no system call
+    static std::atomic<uint64_t> sequence([]
+    {
+        std::random_device rd;
+        return (static_cast<uint64_t>(rd()) << 32u) ^ rd();
+    }());
+
+    uint64_t x = sequence.fetch_add(0x9e3779b97f4a7c15ull, std::memory_order_relaxed);
+    return splitMix(x);
+}
+
+bool Random::ParseEngine(const char *name, Engine &engine)
+{
+    if (std::strcmp(name, "xoshiro") == 0)
+        engine = Engine::XOSHIRO;
+    else if (std::strcmp(name, "pcg") == 0)
+        engine = Engine::PCG;
+    else
+        return false;
+    return true;
+}
@@ -0,0 +1,345 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Maps a ROM directory and keeps its index up to date
+ *
+ * Index layout (all integers little-endian):
+ *   "C8RC"            magic
+ *   u16               format version
+ *   u32               number of entries
+ *   entries, each:
+ *     u16             name length, then the name's bytes
+ *     u64             file size in bytes
+ *     u64             modification time, in the filesystem clock's ticks
+ *     u64             FNV-1a hash of the image
+ *     u8              detected quirk profile (Quirks::Profile)
+ *     bytes           code map, (size + 7) / 8 bytes; none when the ROM
+ *                     does not fit in its profile's memory
+ *
+ * An entry is reused while the file keeps its size and modification time.
+ * The index is rewritten through a temporary file and a rename, so
+ * sessions opening the library concurrently never read a torn index.
+ *****************************************************************************/
+
+#include "RomCatalog.hpp"
+#include "ControlFlow.hpp"
+#include "InputLog.hpp"
+#include "chip8.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CHIP8_ROM_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace
+{
+const char INDEX_MAGIC[4] = {'C', '8', 'R', 'C'};
+// 2: code maps from a decoder where FX00 and FX02 with X != 0 are invalid
+// 3: no code map for a ROM too large for its profile's memory
+const uint16_t INDEX_VERSION = 3;
+const char *const INDEX_NAME = ".chip8-catalog";
+
+struct Cached
+{
+    uint64_t size;
+    uint64_t mtime;
+    uint64_t hash;
+    Quirks::Profile quirks;
+    std::vector<uint8_t> code;
+};
+
+// Whether load_rom accepts the ROM under `profile`
+bool fitsInMemory(size_t size, Quirks::Profile profile)
+{
+    return size <= Quirks::MemoryBytes(Quirks::Of(profile)) - START_ADDRESS;
+}
+
+size_t codeMapBytes(size_t size, Quirks::Profile profile)
+{
+    return fitsInMemory(size, profile) ? (size + 7) / 8 : 0;
+}
+
+// One bit per instruction start, from the same walk the disassembler uses
+std::vector<uint8_t> mapCode(const uint8_t *rom, size_t size, Quirks::Profile profile)
+{
+    std::vector<uint8_t> code(codeMapBytes(size, profile));
+    if (code.empty())
+        return code;
+
+    ControlFlow::Graph graph = ControlFlow::Analyse(rom, size);
+    for (size_t offset = 0; offset < graph.bytes.size(); ++offset)
+    {
+        if (graph.bytes[offset] == ControlFlow::Byte::CODE)
+            code[offset / 8] |= static_cast<uint8_t>(1u << (offset % 8));
+    }
+    return code;
+}
+
+void putBytes(std::ofstream &out, uint64_t v, unsigned int count)
+{
+    for (unsigned int i = 0; i < count; ++i)
+        out.put(static_cast<char>(v >> (8 * i)));
+}
+
+// Reads past the end leave `ok` false and yield zeros
+class IndexReader
+{
+  public:
+    IndexReader(const uint8_t *data, size_t size) : p(data), end(data + size) {}
+
+    bool ok() const { return good; }
+
+    uint64_t bytes(unsigned int count)
+    {
+        if (!good || static_cast<size_t>(end - p) < count)
+        {
+            good = false;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (unsigned int i = 0; i < count; ++i)
+            v |= static_cast<uint64_t>(*p++) << (8 * i);
+        return v;
+    }
+    const uint8_t *span(size_t count)
+    {
+        if (!good || static_cast<size_t>(end - p) < count)
+        {
+            good = false;
+            return nullptr;
+        }
+        const uint8_t *start = p;
+        p += count;
+        return start;
+    }
+
+  private:
+    const uint8_t *p;
+    const uint8_t *end;
+    bool good = true;
+};
+
+// A missing or unreadable index just means every ROM gets analysed
+std::unordered_map<std::string, Cached> loadIndex(const fs::path &path)
+{
+    std::unordered_map<std::string, Cached> cached;
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return cached;
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    IndexReader r(data.data(), data.size());
+    const uint8_t *magic = r.span(sizeof(INDEX_MAGIC));
+    if (!magic || std::memcmp(magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || r.bytes(2) != INDEX_VERSION)
+        return cached;
+
+    uint64_t count = r.bytes(4);
+    for (uint64_t i = 0; i < count && r.ok(); ++i)
+    {
+        size_t nameLength = static_cast<size_t>(r.bytes(2));
+        const uint8_t *name = r.span(nameLength);
+        Cached entry;
+        entry.size = r.bytes(8);
+        entry.mtime = r.bytes(8);
+        entry.hash = r.bytes(8);
+        entry.quirks = static_cast<Quirks::Profile>(r.bytes(1));
+        if (!r.ok() || entry.quirks >= Quirks::Profile::COUNT)
+            break;
+        size_t mapBytes = codeMapBytes(static_cast<size_t>(entry.size), entry.quirks);
+        const uint8_t *code = r.span(mapBytes);
+        if (!r.ok())
+            break;
+        entry.code.assign(code, code + mapBytes);
+        cached[std::string(reinterpret_cast<const char *>(name), nameLength)] = std::move(entry);
+    }
+    return cached;
+}
+
+int saveIndex(const fs::path &path, const std::vector<RomCatalog::Rom> &roms,
+              const std::vector<uint64_t> &mtimes)
+{
+    fs::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return 1;
+
+        file.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+        putBytes(file, INDEX_VERSION, 2);
+        putBytes(file, roms.size(), 4);
+        for (size_t i = 0; i < roms.size(); ++i)
+        {
+            const RomCatalog::Rom &rom = roms[i];
+            putBytes(file, rom.name.size(), 2);
+            file.write(rom.name.data(), static_cast<std::streamsize>(rom.name.size()));
+            putBytes(file, rom.size, 8);
+            putBytes(file, mtimes[i], 8);
+            putBytes(file, rom.hash, 8);
+            putBytes(file, static_cast<uint64_t>(rom.quirks), 1);
+            file.write(reinterpret_cast<const char *>(rom.code.data()), static_cast<std::streamsize>(rom.code.size()));
+        }
+        if (!file)
+            return 1;
+    }
+
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    return error ? 1 : 0;
+}
+
+// Returns nullptr, with `size` zero, for empty files and on failure
+void *mapFile(const fs::path &path, size_t &size)
+{
+    size = 0;
+#ifdef CHIP8_ROM_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat info;
+    void *base = nullptr;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        base = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (base == MAP_FAILED)
+            base = nullptr;
+        else
+            size = static_cast<size_t>(info.st_size);
+    }
+    close(fd);
+    return base;
+#else
+    // No mmap here: one private copy per ROM, still shared by every machine
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return nullptr;
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.empty())
+        return nullptr;
+    uint8_t *base = new uint8_t[data.size()];
+    std::memcpy(base, data.data(), data.size());
+    size = data.size();
+    return base;
+#endif
+}
+
+void unmapFile(void *base, size_t size)
+{
+#ifdef CHIP8_ROM_MMAP
+    munmap(base, size);
+#else
+    (void)size;
+    delete[] static_cast<uint8_t *>(base);
+#endif
+}
+} // namespace
+
+int RomCatalog::Open(const std::string &directory, const std::string &indexPath)
+{
+    Close();
+
+    std::error_code error;
+    std::vector<std::string> names;
+    for (fs::directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+    {
+        std::string name = it->path().filename().string();
+        if (!name.empty() && name[0] != '.' && it->is_regular_file(error))
+            names.push_back(name);
+    }
+    if (error)
+    {
+        std::cerr << "Failed to read ROM directory: " << directory << " (" << error.message() << ")\n";
+        return 1;
+    }
+    // Directory order is arbitrary; a sorted catalog lists the same way everywhere
+    std::sort(names.begin(), names.end());
+
+    fs::path index = indexPath.empty() ? fs::path(directory) / INDEX_NAME : fs::path(indexPath);
+    std::unordered_map<std::string, Cached> cached = loadIndex(index);
+
+    std::vector<uint64_t> mtimes;
+    for (const std::string &name : names)
+    {
+        fs::path path = fs::path(directory) / name;
+        size_t size = 0;
+        void *base = mapFile(path, size);
+        if (!base)
+        {
+            // Empty files are skipped quietly
+            if (!fs::is_empty(path, error))
+                std::cerr << "Failed to map ROM: " << path.string() << "\n";
+            continue;
+        }
+        mappings.push_back({base, size});
+
+        Rom rom;
+        rom.name = name;
+        rom.data = static_cast<const uint8_t *>(base);
+        rom.size = size;
+
+        uint64_t mtime = static_cast<uint64_t>(fs::last_write_time(path, error).time_since_epoch().count());
+        auto hit = cached.find(name);
+        if (hit != cached.end() && hit->second.size == size && hit->second.mtime == mtime)
+        {
+            rom.hash = hit->second.hash;
+            rom.quirks = hit->second.quirks;
+            rom.code = std::move(hit->second.code);
+        }
+        else
+        {
+            rom.hash = SessionInfo::HashRom(rom.data, size);
+            rom.quirks = Quirks::Detect(rom.data, size);
+            rom.code = mapCode(rom.data, size, rom.quirks);
+            ++analysed;
+        }
+        rom.fits = fitsInMemory(size, rom.quirks);
+
+        byHash.emplace(rom.hash, roms.size());
+        roms.push_back(std::move(rom));
+        mtimes.push_back(mtime);
+    }
+
+    // Rewrite only when something changed, including ROMs that went away
+    if ((analysed > 0 || cached.size() != roms.size()) && saveIndex(index, roms, mtimes) != 0)
+        std::cerr << "Failed to write ROM index: " << index.string() << "\n";
+    return 0;
+}
+
+void RomCatalog::Close()
+{
+    for (const Mapping &m : mappings)
+        unmapFile(m.base, m.size);
+    mappings.clear();
+    roms.clear();
+    byHash.clear();
+    analysed = 0;
+}
+
+const RomCatalog::Rom *RomCatalog::Find(uint64_t hash) const
+{
+    auto it = byHash.find(hash);
+    return it == byHash.end() ? nullptr : &roms[it->second];
+}
+
+const RomCatalog::Rom *RomCatalog::FindName(const std::string &name) const
+{
+    for (const Rom &rom : roms)
+    {
+        if (rom.name == name)
+            return &rom;
+    }
+    return nullptr;
+}
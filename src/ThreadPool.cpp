@@ -0,0 +1,121 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Implements the work-stealing thread pool
+ *****************************************************************************/
+
+#include "ThreadPool.hpp"
+#include <chrono>
+
+namespace
+{
+// Index of the pool queue owned by the calling thread, or -1 outside the pool
+thread_local int localQueue = -1;
+} // namespace
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0)
+        threadCount = 1;
+
+    for (unsigned int i = 0; i < threadCount; ++i)
+        queues.push_back(std::make_unique<Queue>());
+
+    for (unsigned int i = 0; i < threadCount; ++i)
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::Submit(Task task)
+{
+    // Tasks spawned from inside the pool stay on the spawning worker's queue;
+    // external submissions are spread round-robin.
+    unsigned int id = localQueue >= 0
+                          ? static_cast<unsigned int>(localQueue)
+                          : nextQueue++ % Size();
+
+    pending++;
+    {
+        std::lock_guard<std::mutex> guard(queues[id]->lock);
+        queues[id]->tasks.push_back(std::move(task));
+    }
+
+    std::lock_guard<std::mutex> guard(sleepLock);
+    workAvailable.notify_one();
+}
+
+void ThreadPool::Wait()
+{
+    std::unique_lock<std::mutex> guard(sleepLock);
+    allDone.wait(guard, [this]
+                 { return pending == 0; });
+}
+
+bool ThreadPool::PopLocal(unsigned int id, Task &task)
+{
+    std::lock_guard<std::mutex> guard(queues[id]->lock);
+    if (queues[id]->tasks.empty())
+        return false;
+
+    task = std::move(queues[id]->tasks.back());
+    queues[id]->tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::Steal(unsigned int id, Task &task)
+{
+    for (unsigned int offset = 1; offset < Size(); ++offset)
+    {
+        Queue &victim = *queues[(id + offset) % Size()];
+        std::unique_lock<std::mutex> guard(victim.lock, std::try_to_lock);
+        if (!guard.owns_lock() || victim.tasks.empty())
+            continue;
+
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::WorkerLoop(unsigned int id)
+{
+    localQueue = static_cast<int>(id);
+
+    while (true)
+    {
+        Task task;
+        if (PopLocal(id, task) || Steal(id, task))
+        {
+            task();
+            if (--pending == 0)
+            {
+                std::lock_guard<std::mutex> guard(sleepLock);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleepLock);
+        if (stopping)
+            return;
+        // The timeout covers the window where a task lands on a queue after
+        // the steal sweep but before this thread starts waiting.
+        workAvailable.wait_for(guard, std::chrono::milliseconds(1));
+    }
+}
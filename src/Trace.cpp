@@ -0,0 +1,288 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Drains the trace ring to disk and reads traces back
+ *
+ * Layout:
+ *   "C8TR"            magic
+ *   u16               format version (3)
+ *   u16               word size in bytes (8)
+ *   u32               0x01020304 in the writer's byte order
+ *   events, each starting with a u64 in the writer's byte order:
+ *     bits 0-55       instruction count the event happened at
+ *     bits 56-63      type: 0 keyframe, otherwise a TraceEvent
+ *   a keyframe continues with
+ *     u64             length of the save state in bytes
+ *     bytes           Processor::save_state, zero-padded to whole words
+ *   any other event with a u64 value:
+ *     KEYS            the keypad bits from this count on
+ *     SKIP            instructions fast-forwarded from this count on
+ *     others          0
+ *
+ * A keyframe comes first, when the tracer is attached, and again whenever
+ * the machine is loaded, reset, reseeded or changes profile. Between them
+ * the reader executes instructions one by one from the keyframe's state,
+ * applying each event once the count reaches it.
+ *
+ * Words are stored exactly as they sit in the ring so the writer thread can
+ * hand whole stretches of it to the file; the byte-order word lets a reader
+ * on a host of the other endianness refuse the file.
+ *****************************************************************************/
+
+#include "Trace.hpp"
+#include "chip8.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+
+namespace
+{
+const char TRACE_MAGIC[4] = {'C', '8', 'T', 'R'};
+const uint16_t TRACE_VERSION = 3;
+const uint32_t ORDER_MARK = 0x01020304;
+
+const uint64_t CYCLE_MASK = (uint64_t(1) << TraceWriter::TYPE_SHIFT) - 1;
+
+// How long the writer rests between small batches
+const std::chrono::microseconds DRAIN_INTERVAL(200);
+} // namespace
+
+int TraceWriter::Open(const char *filename, size_t capacity)
+{
+    Close();
+
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open trace for writing: " << filename << "\n";
+        return 1;
+    }
+
+    uint16_t version = TRACE_VERSION;
+    uint16_t wordSize = sizeof(uint64_t);
+    file.write(TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char *>(&wordSize), sizeof(wordSize));
+    file.write(reinterpret_cast<const char *>(&ORDER_MARK), sizeof(ORDER_MARK));
+
+    // At least one event
+    size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+    ring.assign(size, 0);
+    slots = ring.data();
+    mask = size - 1;
+
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    cachedTail = 0;
+    stalls = 0;
+    lastKeys = 0;
+    failed = false;
+    stopping.store(false, std::memory_order_relaxed);
+    writer = std::thread(&TraceWriter::drain, this);
+    return 0;
+}
+
+int TraceWriter::Close()
+{
+    if (!writer.joinable())
+        return 0;
+
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+    file.close();
+    if (failed || !file)
+    {
+        std::cerr << "Error writing trace\n";
+        return 1;
+    }
+    return 0;
+}
+
+void TraceWriter::wait(uint64_t h, size_t words)
+{
+    cachedTail = tail.load(std::memory_order_acquire);
+    if (h + words - cachedTail <= ring.size())
+        return;
+
+    ++stalls;
+    do
+    {
+        std::this_thread::yield();
+        cachedTail = tail.load(std::memory_order_acquire);
+    } while (h + words - cachedTail > ring.size());
+}
+
+void TraceWriter::Keyframe(uint64_t cycle, const std::vector<uint8_t> &state, uint16_t keys)
+{
+    std::vector<uint64_t> words(2 + (state.size() + 7) / 8);
+    words[0] = cycle & CYCLE_MASK;
+    words[1] = state.size();
+    if (!state.empty())
+        std::memcpy(&words[2], state.data(), state.size());
+    lastKeys = keys;
+
+    // A state larger than the ring goes in as several stretches
+    uint64_t h = head.load(std::memory_order_relaxed);
+    for (size_t done = 0; done < words.size();)
+    {
+        size_t count = std::min(words.size() - done, ring.size());
+        if (h + count - cachedTail > ring.size())
+            wait(h, count);
+        for (size_t i = 0; i < count; ++i)
+            slots[(h + i) & mask] = words[done + i];
+        h += count;
+        done += count;
+        head.store(h, std::memory_order_release);
+    }
+}
+
+void TraceWriter::drain()
+{
+    uint64_t t = tail.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        // Read the flag first: once it is seen, every record is already
+        // visible and one more pass drains the rest
+        bool last = stopping.load(std::memory_order_acquire);
+        uint64_t h = head.load(std::memory_order_acquire);
+        uint64_t pending = h - t;
+
+        while (t != h)
+        {
+            // Up to the end of the ring at most; a wrapped stretch takes two writes
+            size_t start = t & mask;
+            size_t count = static_cast<size_t>(std::min<uint64_t>(h - t, ring.size() - start));
+            if (!failed)
+            {
+                file.write(reinterpret_cast<const char *>(&ring[start]), count * sizeof(uint64_t));
+                failed = !file;
+            }
+            t += count;
+            // Hand the slots back even after a write error so the producer
+            // never stalls forever
+            tail.store(t, std::memory_order_release);
+        }
+
+        if (last)
+            break;
+        // Small batches mean the producer is slow: rest so the next write is
+        // a large one. Spinning on head would also pull its cache line away
+        // from the producer on every record.
+        if (pending < ring.size() / 8)
+            std::this_thread::sleep_for(DRAIN_INTERVAL);
+    }
+    file.flush();
+}
+
+int LoadTrace(const char *filename, std::vector<TraceRecord> &records)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open trace: " << filename << "\n";
+        return 1;
+    }
+
+    char magic[sizeof(TRACE_MAGIC)] = {};
+    uint16_t version = 0;
+    uint16_t wordSize = 0;
+    uint32_t byteOrder = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    file.read(reinterpret_cast<char *>(&wordSize), sizeof(wordSize));
+    file.read(reinterpret_cast<char *>(&byteOrder), sizeof(byteOrder));
+    if (!file || std::memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0)
+    {
+        std::cerr << "Not a CHIP-8 trace: " << filename << "\n";
+        return 1;
+    }
+    if (version != TRACE_VERSION || wordSize != sizeof(uint64_t) || byteOrder != ORDER_MARK)
+    {
+        std::cerr << "Unsupported trace format (version " << version << ", written on a host of "
+                  << (byteOrder == ORDER_MARK ? "this" : "another") << " byte order)\n";
+        return 1;
+    }
+
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.size() % sizeof(uint64_t) != 0)
+        std::cerr << "Trace ends in a partial word, ignoring it\n";
+
+    std::vector<uint64_t> words(data.size() / sizeof(uint64_t));
+    if (!words.empty())
+        std::memcpy(words.data(), data.data(), words.size() * sizeof(uint64_t));
+
+    records.clear();
+
+    // Replays from each keyframe, stepping one instruction at a time so
+    // every one gets its record
+    Processor cpu;
+    bool started = false;
+    uint64_t now = 0;
+    auto step = [&](uint64_t cycle)
+    {
+        uint16_t pc = cpu.get_pc();
+        uint16_t opcode = cpu.get_opcode(pc);
+        cpu.cycle();
+        Instr in = Processor::decode(opcode);
+        records.push_back({cycle, pc, opcode, cpu.get_index(), cpu.get_register(in.x), cpu.get_register(0xF)});
+    };
+    auto advance = [&](uint64_t cycle)
+    {
+        while (now < cycle)
+            step(now++);
+    };
+
+    for (size_t i = 0; i + 2 <= words.size();)
+    {
+        uint64_t cycle = words[i] & CYCLE_MASK;
+        unsigned int type = static_cast<unsigned int>(words[i] >> TraceWriter::TYPE_SHIFT);
+        uint64_t value = words[i + 1];
+        i += 2;
+
+        if (type == 0)
+        {
+            size_t stateWords = static_cast<size_t>((value + 7) / 8);
+            if (value > words.size() * sizeof(uint64_t) || i + stateWords > words.size())
+            {
+                std::cerr << "Trace ends partway through a keyframe, ignoring it\n";
+                break;
+            }
+            if (started)
+                advance(cycle);
+            if (cpu.load_state(reinterpret_cast<const uint8_t *>(&words[i]), static_cast<size_t>(value)) != 0)
+                return 1;
+            i += stateWords;
+            started = true;
+            now = cycle;
+            continue;
+        }
+        if (!started)
+        {
+            std::cerr << "Trace does not start with a keyframe\n";
+            return 1;
+        }
+
+        advance(cycle);
+        switch (static_cast<TraceEvent>(type))
+        {
+        case TraceEvent::KEYS:
+            for (unsigned int k = 0; k < NUM_KEYS; ++k)
+                cpu.keypad[k] = (value >> k) & 1u;
+            break;
+        case TraceEvent::TICK: cpu.tick_timers(); break;
+        case TraceEvent::SKIP: now += value; break;
+        case TraceEvent::RUN: break;
+        case TraceEvent::STEP: step(cycle); break;
+        default:
+            std::cerr << "Unknown trace event " << type << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -6,11 +6,12 @@
  * Description: Implements some basic CPU functions
  *****************************************************************************/
 
+#include "Profiler.hpp"
 #include "chip8.hpp"
-#include <random>
 #include <fstream>
 #include <cstring>
 #include <iostream>
+#include <iterator>
 
 int Processor::load_rom(char *filename)
 {
@@ -22,98 +23,176 @@ int Processor::load_rom(char *filename)
         return 1;
     }
 
-    int available_memory = MEM_SIZE_BYTES - START_ADDRESS;
-    rom.read(reinterpret_cast<char *>(memory + START_ADDRESS), available_memory);
-
-    if (!rom && !rom.eof())
+    std::vector<uint8_t> image((std::istreambuf_iterator<char>(rom)), std::istreambuf_iterator<char>());
+    if (rom.bad())
     {
         std::cerr << "Error reading ROM: " << filename << "\n";
         return 1;
     }
+    return load_rom(image.data(), image.size());
+}
+
+int Processor::load_rom(const uint8_t *data, size_t size)
+{
+    size_t available_memory = Quirks::MemoryBytes(Quirks::Of(quirks)) - START_ADDRESS;
+
+    if (size > available_memory)
+    {
+        std::cerr << "ROM too large for the " << Quirks::Name(quirks) << " profile: " << size
+                  << " bytes (max " << available_memory << ")\n";
+        return 1;
+    }
 
+    uint32_t end = START_ADDRESS + static_cast<uint32_t>(size);
+    std::memcpy(&memory[START_ADDRESS], data, size);
+    memory.NoteWritten(START_ADDRESS, end);
+    rom_end = end;
+    trace_keyframe();
     return 0;
 }
 
-Processor::Processor()
+Processor::Processor() : rng(Random::EntropySeed())
 {
-    std::memset(video, 0, sizeof(video));
+    // Processor is not standard-layout, but GCC and Clang lay it out in
+    // declaration order, which is all offsetof needs here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+    static_assert(offsetof(Processor, executed) + sizeof(executed) <= 64,
+                  "The hot state must fit the object's first cache line");
+#pragma GCC diagnostic pop
+
+    std::memset(display, 0, sizeof(display));
     pc = START_ADDRESS;
+    set_quirks(Quirks::Profile::MODERN);
+    load_fonts();
+}
 
-    for (size_t i = 0; i < FONTSET_SIZE; ++i)
-    {
-        memory[FONTSET_START_ADDRESS + i] = fontset[i];
-    }
+void Processor::load_fonts()
+{
+    std::memcpy(&memory[FONTSET_START_ADDRESS], fontset, FONTSET_SIZE);
+    std::memcpy(&memory[BIG_FONTSET_START_ADDRESS], big_fontset, BIG_FONTSET_SIZE);
+    memory.NoteWritten(FONTSET_START_ADDRESS, BIG_FONTSET_START_ADDRESS + BIG_FONTSET_SIZE);
+}
+
+void Processor::reset()
+{
+    // Everything the constructor sets up, member by member; a ROM rarely
+    // writes more than a few KiB, so that is all the memory that is cleared
+    memory.Clear();
+    load_fonts();
+    rom_end = 0;
 
-    table[0x0] = &Processor::Table0;
-    table[0x1] = &Processor::OP_1nnn;
-    table[0x2] = &Processor::OP_2nnn;
-    table[0x3] = &Processor::OP_3xnn;
-    table[0x4] = &Processor::OP_4xnn;
-    table[0x5] = &Processor::OP_5xy0;
-    table[0x6] = &Processor::OP_6xnn;
-    table[0x7] = &Processor::OP_7xnn;
-    table[0x8] = &Processor::Table8;
-    table[0x9] = &Processor::OP_9xy0;
-    table[0xA] = &Processor::OP_Annn;
-    table[0xB] = &Processor::OP_Bnnn;
-    table[0xC] = &Processor::OP_Cxnn;
-    table[0xD] = &Processor::OP_Dxyn;
-    table[0xE] = &Processor::TableE;
-    table[0xF] = &Processor::TableF;
-
-    for (size_t i = 0; i <= 0xE; ++i)
+    std::memset(registers, 0, sizeof(registers));
+    pc = START_ADDRESS;
+    index = 0;
+    stack_pointer = 0;
+    delay_timer = 0;
+    sound_timer = 0;
+    hires = false;
+    planes = 1;
+    side_effects = 0;
+    frame_left = 0;
+    dirty_rows = ~0ull;
+    executed = 0;
+    // Still a change of picture for anyone comparing generations
+    ++generation;
+
+    std::memset(keypad, 0, sizeof(keypad));
+    std::memset(display, 0, sizeof(display));
+    std::memset(stack, 0, sizeof(stack));
+    std::memset(flags, 0, sizeof(flags));
+    std::memset(audio_pattern, 0, sizeof(audio_pattern));
+    pitch = 64;
+    scheduler = Scheduler(scheduler.InstructionsPerSecond());
+
+    idle_countdown = 1;
+    idle_probe = {};
+    idle_clock = 0;
+    idle_armed = false;
+    idle_matched = false;
+    idle_interval = 1;
+    trace_keyframe();
+}
+
+uint64_t Processor::state_hash() const
+{
+    // FNV-1a over every piece of state an instruction can observe
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto mix = [&hash](const void *data, size_t size)
     {
-        table0[i] = &Processor::OP_NULL;
-        table8[i] = &Processor::OP_NULL;
-        tableE[i] = &Processor::OP_NULL;
-    }
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+    };
+
+    mix(registers, sizeof(registers));
+    mix(memory.Bytes(), memory.Size());
+    mix(&index, sizeof(index));
+    mix(&pc, sizeof(pc));
+    mix(stack, sizeof(stack));
+    mix(&stack_pointer, sizeof(stack_pointer));
+    mix(&delay_timer, sizeof(delay_timer));
+    mix(&sound_timer, sizeof(sound_timer));
+    mix(display, sizeof(display));
+    mix(&hires, sizeof(hires));
+    mix(&planes, sizeof(planes));
+    mix(flags, sizeof(flags));
+    mix(audio_pattern, sizeof(audio_pattern));
+    mix(&pitch, sizeof(pitch));
+    return hash;
+}
+
+void Processor::render_rgba(const DisplayBits &display, bool hires, uint32_t *out, uint64_t rows)
+{
+    // Off, plane 0 only, plane 1 only, both
+    static const uint32_t PALETTE[4] = {0, 0xFFFFFFFF, 0xFFAAAAAA, 0xFF555555};
+    const unsigned int width = Display::Width(hires);
+    const unsigned int height = Display::Height(hires);
 
-    for (size_t i = 0; i <= 0x65; ++i)
+    for (unsigned int y = 0; y < height; ++y, out += width)
     {
-        tableF[i] = &Processor::OP_NULL;
+        if (!((rows >> y) & 1u))
+            continue;
+
+        for (unsigned int w = 0; w < Display::Words(hires); ++w)
+        {
+            uint64_t low = display[0][y][w];
+            uint64_t high = display[1][y][w];
+            for (unsigned int x = 0; x < 64; ++x)
+            {
+                unsigned int shift = 63u - x;
+                out[w * 64 + x] = PALETTE[((low >> shift) & 1u) | (((high >> shift) & 1u) << 1u)];
+            }
+        }
     }
-
-    table0[0x0] = &Processor::OP_00E0;
-    table0[0xE] = &Processor::OP_00EE;
-
-    table8[0x0] = &Processor::OP_8xy0;
-    table8[0x1] = &Processor::OP_8xy1;
-    table8[0x2] = &Processor::OP_8xy2;
-    table8[0x3] = &Processor::OP_8xy3;
-    table8[0x4] = &Processor::OP_8xy4;
-    table8[0x5] = &Processor::OP_8xy5;
-    table8[0x6] = &Processor::OP_8xy6;
-    table8[0x7] = &Processor::OP_8xy7;
-    table8[0xE] = &Processor::OP_8xyE;
-
-    tableE[0x1] = &Processor::OP_Exa1;
-    tableE[0xE] = &Processor::OP_Ex9e;
-
-    tableF[0x07] = &Processor::OP_Fx07;
-    tableF[0x0A] = &Processor::OP_Fx0a;
-    tableF[0x15] = &Processor::OP_Fx15;
-    tableF[0x18] = &Processor::OP_Fx18;
-    tableF[0x1E] = &Processor::OP_Fx1e;
-    tableF[0x29] = &Processor::OP_Fx29;
-    tableF[0x33] = &Processor::OP_Fx33;
-    tableF[0x55] = &Processor::OP_Fx55;
-    tableF[0x65] = &Processor::OP_Fx65;
 }
 
-uint8_t Processor::randGen()
+void Processor::trace_keyframe()
 {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> distrib(0, 255);
-    return static_cast<uint8_t>(distrib(gen));
+    if (tracer)
+        tracer->Keyframe(executed, save_state(), keypad_bits());
 }
 
-void Processor::cycle()
+uint16_t Processor::keypad_bits() const
 {
-    opcode = (memory[pc] << 8u) | memory[pc + 1];
-    pc += 2;
+    uint16_t keys = 0;
+    for (unsigned int k = 0; k < NUM_KEYS; ++k)
+    {
+        if (keypad[k])
+            keys |= static_cast<uint16_t>(1u << k);
+    }
+    return keys;
+}
 
-    ((*this).*(table[(opcode & 0xF000u) >> 12u]))();
+void Processor::tick_timers()
+{
+    // Loops seen before the tick may behave differently after it
+    idle_reset();
+    if (tracer)
+        tracer->Event(TraceEvent::TICK, executed);
 
     if (delay_timer > 0)
     {
@@ -124,4 +203,6 @@ void Processor::cycle()
     {
         --sound_timer;
     }
+
+    CHIP8_PROFILE_POLL();
 }
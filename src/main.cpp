@@ -6,62 +6,496 @@
  * Description: Main file
  *****************************************************************************/
 
+#include "Audio.hpp"
+#include "FrameSink.hpp"
+#include "FrameStats.hpp"
+#include "InputLog.hpp"
 #include "Platform.hpp"
+#include "Scheduler.hpp"
+#include "Trace.hpp"
+#include "TripleBuffer.hpp"
 #include "chip8.hpp"
+#include <atomic>
 #include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <stdexcept>
+#include <thread>
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+// Like the scheduler's backlog cap: after a longer stall, drop the missed
+// frames instead of sprinting through them
+constexpr unsigned int MAX_CATCH_UP_TICKS = 15;
+
+// Converted frames are sized for high resolution; rows are packed at the
+// width of the current mode
+typedef uint32_t FrameBuffer[HIRES_WIDTH * HIRES_HEIGHT];
+
+int framePitch(bool hires)
+{
+    return static_cast<int>(sizeof(uint32_t) * Display::Width(hires));
+}
+
+// Follows a resolution switch; every row must then be converted and uploaded
+void resizeTexture(Platform &platform, bool hires)
+{
+    platform.SetTextureSize(static_cast<int>(Display::Width(hires)), static_cast<int>(Display::Height(hires)));
+}
+
+struct Timings
+{
+    FrameStats frames;    // Wall time between frame starts
+    FrameStats emulation; // Wall time spent emulating each frame's burst
+};
+
+double millisecondsBetween(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+Clock::duration tickDuration()
+{
+    return std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(Scheduler::TICK_SECONDS));
+}
+
+// Number of 60 Hz deadlines that have passed by `now`, moving the deadline
+// to the next one still ahead
+unsigned int dueTicks(Clock::time_point &deadline, Clock::time_point now, Clock::duration tick)
+{
+    unsigned int ticks = 0;
+    while (deadline <= now && ticks < MAX_CATCH_UP_TICKS)
+    {
+        deadline += tick;
+        ++ticks;
+    }
+    if (deadline <= now)
+        deadline = now + tick;
+    return ticks;
+}
+
+// The --video format follows the file extension; Y4M unless .raw or .pbm
+FrameSink::Format videoFormat(const std::string &path)
+{
+    auto endsWith = [&](const char *suffix)
+    {
+        size_t n = std::strlen(suffix);
+        return path.size() >= n && path.compare(path.size() - n, n, suffix) == 0;
+    };
+    if (endsWith(".raw"))
+        return FrameSink::Format::RAW;
+    if (endsWith(".pbm"))
+        return FrameSink::Format::PBM;
+    return FrameSink::Format::Y4M;
+}
+
+void runFrame(Processor &chip8, FrameSink &video, AudioStream &audio)
+{
+    chip8.run_until_frame();
+    if (video.IsOpen())
+        video.Capture(chip8);
+    if (audio.IsOpen())
+        audio.Push(chip8);
+}
+
+// Runs the frames that are due in one burst; returns how many frames the
+// burst stood for. The keypad the burst starts with is what gets recorded.
+unsigned int emulateFrames(Processor &chip8, InputRecorder &recorder, FrameSink &video, AudioStream &audio,
+                           unsigned int ticks, bool turbo, Clock::time_point start, Clock::duration tick)
+{
+    recorder.Sample(chip8.get_cycles(), chip8.keypad);
+
+    if (turbo)
+    {
+        // Fast-forward: emulate as many frames as the host manages in one
+        // display interval, then present once
+        auto turboEnd = start + tick;
+        do
+        {
+            for (int i = 0; i < 16; ++i)
+                runFrame(chip8, video, audio);
+        } while (Clock::now() < turboEnd);
+        return 1;
+    }
+
+    for (unsigned int i = 0; i < ticks; ++i)
+        runFrame(chip8, video, audio);
+    return ticks;
+}
+
+// Sleeps until the deadline, taking input as it arrives. The event wait
+// stops a millisecond early and a precise sleep covers the remainder, so
+// waking is neither late by a scheduler quantum nor a busy loop.
+bool waitForDeadline(Platform &platform, uint8_t *keys, Clock::time_point deadline)
+{
+    for (;;)
+    {
+        auto now = Clock::now();
+        if (now >= deadline)
+            return false;
+
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count();
+        if (remaining > 1)
+        {
+            if (platform.WaitInput(keys, static_cast<int>(remaining - 1)))
+                return true;
+        }
+        else
+        {
+            std::this_thread::sleep_until(deadline);
+        }
+    }
+}
+
+// Emulation, conversion and presentation on one thread
+void runPaced(Platform &platform, Processor &chip8, InputRecorder &recorder, FrameSink &video,
+              AudioStream &audio, double instructionsPerSecond, bool vsync, Timings &timings)
+{
+    FrameBuffer frame = {};
+    bool hires = false;
+    Scheduler scheduler(instructionsPerSecond);
+
+    const auto tick = tickDuration();
+    auto lastFrame = Clock::now();
+    auto deadline = lastFrame + tick;
+    bool quit = false;
+
+    while (!quit)
+    {
+        if (vsync)
+        {
+            // The previous present blocked until the vertical blank, so the
+            // display refresh paces this loop
+            quit = platform.ProcessInput(chip8.keypad);
+        }
+        else
+        {
+            quit = waitForDeadline(platform, chip8.keypad, deadline) ||
+                   platform.ProcessInput(chip8.keypad);
+        }
+
+        auto frameStart = Clock::now();
+        timings.frames.Add(millisecondsBetween(lastFrame, frameStart));
+
+        // Under vsync the scheduler turns whatever the refresh rate is into
+        // 60 Hz frames
+        unsigned int ticks = vsync
+                                 ? scheduler.Advance(std::chrono::duration<double>(frameStart - lastFrame).count())
+                                 : dueTicks(deadline, frameStart, tick);
+        lastFrame = frameStart;
+
+        ticks = emulateFrames(chip8, recorder, video, audio, ticks, platform.TurboHeld(), frameStart, tick);
+        if (ticks)
+            timings.emulation.Add(millisecondsBetween(frameStart, Clock::now()));
+
+        uint64_t dirtyRows = chip8.take_dirty_rows();
+        if (chip8.is_hires() != hires)
+        {
+            hires = chip8.is_hires();
+            resizeTexture(platform, hires);
+            dirtyRows = ~0ull;
+        }
+        if (dirtyRows)
+            chip8.render_rgba(frame, dirtyRows);
+
+        // With vsync every refresh is presented, as that is what paces the
+        // loop. Otherwise the GPU is only touched when the display changed,
+        // or when a key press has been emulated and its latency is waiting
+        // on a present.
+        if (vsync || dirtyRows || (ticks && platform.InputPending()))
+            platform.Update(frame, framePitch(hires), dirtyRows);
+    }
+}
+
+// What the emulation thread hands to the render thread after each burst
+struct DisplayFrame
+{
+    DisplayBits display;
+    bool hires;
+    uint32_t generation;
+};
+
+// State shared by the two threads. Nothing here blocks: frames go one way
+// through the triple buffer, keys and flags the other way as atomics.
+struct ThreadLink
+{
+    TripleBuffer<DisplayFrame> frames;
+    std::atomic<uint16_t> keys{0}; // Bit k set while key k is down
+    std::atomic<bool> turbo{false};
+    std::atomic<bool> running{true};
+};
+
+// Owns the Processor: sleeps to each 60 Hz deadline on its own, so a
+// present stuck behind the compositor cannot delay emulated time
+void emulationLoop(Processor &chip8, InputRecorder &recorder, FrameSink &video, AudioStream &audio,
+                   ThreadLink &link, Timings &timings)
+{
+    const auto tick = tickDuration();
+    auto lastFrame = Clock::now();
+    auto deadline = lastFrame + tick;
+
+    while (link.running.load(std::memory_order_relaxed))
+    {
+        std::this_thread::sleep_until(deadline);
+
+        auto frameStart = Clock::now();
+        timings.frames.Add(millisecondsBetween(lastFrame, frameStart));
+        unsigned int ticks = dueTicks(deadline, frameStart, tick);
+        lastFrame = frameStart;
+
+        uint16_t keys = link.keys.load(std::memory_order_acquire);
+        for (unsigned int k = 0; k < NUM_KEYS; ++k)
+            chip8.keypad[k] = (keys >> k) & 1u;
+
+        ticks = emulateFrames(chip8, recorder, video, audio, ticks, link.turbo.load(std::memory_order_relaxed),
+                              frameStart, tick);
+        if (!ticks)
+            continue;
+        timings.emulation.Add(millisecondsBetween(frameStart, Clock::now()));
+
+        DisplayFrame &out = link.frames.Back();
+        std::memcpy(out.display, chip8.display, sizeof(out.display));
+        out.hires = chip8.is_hires();
+        out.generation = chip8.display_generation();
+        link.frames.Publish();
+        Platform::Wake();
+    }
+}
+
+// The render side stays on the thread that created the window, as SDL
+// requires: it collects input, converts published frames and presents
+void renderLoop(Platform &platform, ThreadLink &link, bool vsync)
+{
+    // Without vsync the emulation thread's wake-ups pace this loop; the
+    // timeout only bounds how long a lost wake-up could stall it
+    const int WAIT_MS = 100;
+
+    FrameBuffer frame = {};
+    DisplayBits shown = {};
+    bool shownHires = false;
+    uint32_t shownGeneration = 0;
+    uint8_t keys[NUM_KEYS] = {};
+    bool quit = false;
+
+    while (!quit)
+    {
+        quit = vsync ? platform.ProcessInput(keys) : platform.WaitInput(keys, WAIT_MS);
+
+        uint16_t mask = 0;
+        for (unsigned int k = 0; k < NUM_KEYS; ++k)
+            mask |= static_cast<uint16_t>((keys[k] ? 1u : 0u) << k);
+        link.keys.store(mask, std::memory_order_release);
+        link.turbo.store(platform.TurboHeld(), std::memory_order_relaxed);
+
+        bool fresh = link.frames.Update();
+        uint64_t dirtyRows = 0;
+        if (fresh && link.frames.Front().generation != shownGeneration)
+        {
+            // Frames may have been skipped, so compare against what is on
+            // screen rather than trusting per-frame dirty rows
+            const DisplayFrame &latest = link.frames.Front();
+            if (latest.hires != shownHires)
+            {
+                shownHires = latest.hires;
+                resizeTexture(platform, shownHires);
+                dirtyRows = ~0ull;
+            }
+            for (unsigned int y = 0; y < Display::Height(shownHires); ++y)
+            {
+                for (unsigned int p = 0; p < DISPLAY_PLANES; ++p)
+                {
+                    if (std::memcmp(latest.display[p][y], shown[p][y], sizeof(shown[p][y])) != 0)
+                        dirtyRows |= 1ull << y;
+                }
+            }
+            std::memcpy(shown, latest.display, sizeof(shown));
+            shownGeneration = latest.generation;
+            Processor::render_rgba(shown, shownHires, frame, dirtyRows);
+        }
+
+        if (vsync || dirtyRows || (fresh && platform.InputPending()))
+            platform.Update(frame, framePitch(shownHires), dirtyRows);
+    }
+
+    link.running.store(false, std::memory_order_relaxed);
+}
+
+void runThreaded(Platform &platform, Processor &chip8, InputRecorder &recorder, FrameSink &video,
+                 AudioStream &audio, bool vsync, Timings &timings)
+{
+    ThreadLink link;
+    std::thread emulation(emulationLoop, std::ref(chip8), std::ref(recorder), std::ref(video), std::ref(audio),
+                          std::ref(link), std::ref(timings));
+    renderLoop(platform, link, vsync);
+    emulation.join();
+}
+} // namespace
 
 int main(int argc, char **argv)
 {
-    if (argc != 4)
+    bool vsync = false;
+    bool threaded = false;
+    bool stats = false;
+    const char *seed = nullptr;
+    Random::Engine engine = Random::Engine::XOSHIRO;
+    const char *quirks = "auto";
+    const char *record = nullptr;
+    const char *trace = nullptr;
+    const char *video = nullptr;
+    bool mute = false;
+    const char *audioBuffer = nullptr;
+    bool usage = argc < 4;
+    for (int i = 4; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--vsync") == 0)
+            vsync = true;
+        else if (std::strcmp(argv[i], "--threaded") == 0)
+            threaded = true;
+        else if (std::strcmp(argv[i], "--stats") == 0)
+            stats = true;
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = argv[++i];
+        else if (std::strcmp(argv[i], "--rng") == 0 && i + 1 < argc)
+            usage |= !Random::ParseEngine(argv[++i], engine);
+        else if (std::strcmp(argv[i], "--quirks") == 0 && i + 1 < argc)
+            quirks = argv[++i];
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            record = argv[++i];
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            trace = argv[++i];
+        else if (std::strcmp(argv[i], "--video") == 0 && i + 1 < argc)
+            video = argv[++i];
+        else if (std::strcmp(argv[i], "--mute") == 0)
+            mute = true;
+        else if (std::strcmp(argv[i], "--audio-buffer") == 0 && i + 1 < argc)
+            audioBuffer = argv[++i];
+        else
+            usage = true;
+    }
+
+    if (usage)
     {
-        std::cerr << "Usage: " << argv[0] << " <Scale> <Delay(ms)> <ROM>\n";
+        std::cerr << "Usage: " << argv[0]
+                  << " <Scale> <Instructions/sec> <ROM> [--vsync] [--threaded] [--stats]\n"
+                  << "       [--seed n] [--rng xoshiro|pcg] [--quirks auto|modern|chip8|schip|xochip]\n"
+                  << "       [--record session.c8ir] [--trace trace.c8t] [--video out.y4m|.raw|.pbm]\n"
+                  << "       [--mute] [--audio-buffer samples]\n";
         return EXIT_FAILURE;
     }
 
     try
     {
         int videoScale = std::stoi(argv[1]);
-        int cycleDelay = std::stoi(argv[2]);
+        double instructionsPerSecond = std::stod(argv[2]);
         const std::string romFile = argv[3];
 
-        constexpr int VIDEO_WIDTH = 64;
-        constexpr int VIDEO_HEIGHT = 32;
-
         const int windowWidth = VIDEO_WIDTH * videoScale;
         const int windowHeight = VIDEO_HEIGHT * videoScale;
 
-        Platform platform("CHIP-8 Emulator", windowWidth, windowHeight, VIDEO_WIDTH, VIDEO_HEIGHT);
+        // Declared first: the audio callback reads the stream until the
+        // Platform closes the device
+        AudioStream audio;
+        Platform platform("CHIP-8 Emulator", windowWidth, windowHeight, VIDEO_WIDTH, VIDEO_HEIGHT, vsync);
         Processor chip8;
 
-        if (chip8.load_rom(const_cast<char *>(romFile.c_str())) != 0)
+        std::ifstream rom(romFile, std::ios::binary);
+        std::vector<uint8_t> image((std::istreambuf_iterator<char>(rom)), std::istreambuf_iterator<char>());
+
+        // Without an explicit profile, guess from the opcodes the ROM uses
+        Quirks::Profile profile = Quirks::Detect(image.data(), image.size());
+        if (std::strcmp(quirks, "auto") != 0 && !Quirks::Parse(quirks, profile))
+            throw std::invalid_argument(std::string("Unknown quirk profile: ") + quirks);
+
+        // The profile decides how much memory the ROM may fill
+        chip8.set_quirks(profile);
+        if (!rom.is_open() || chip8.load_rom(image.data(), image.size()) != 0)
         {
             std::cerr << "Failed to load ROM: " << romFile << "\n";
             return EXIT_FAILURE;
         }
 
-        const int videoPitch = static_cast<int>(sizeof(chip8.video[0]) * VIDEO_WIDTH);
-        bool quit = false;
+        if (vsync && !platform.VsyncEnabled())
+        {
+            std::cerr << "Vsync not available, pacing frames with a timer\n";
+            vsync = false;
+        }
 
-        auto lastCycleTime = std::chrono::high_resolution_clock::now();
+        if (instructionsPerSecond <= 0)
+            throw std::invalid_argument("Instructions/sec must be positive");
 
-        while (!quit)
+        // Everything a replay needs to start from the same power-on state
+        SessionInfo session;
+        session.seed = seed ? std::stoull(seed) : Random::EntropySeed();
+        session.engine = engine;
+        session.quirks = profile;
+        session.instructionsPerSecond = instructionsPerSecond;
+        session.romHash = SessionInfo::HashRom(image.data(), image.size());
+        session.romSize = static_cast<uint32_t>(image.size());
+        session.Apply(chip8);
+
+        InputRecorder recorder;
+        if (record && recorder.Open(record, session) != 0)
+            return EXIT_FAILURE;
+        TraceWriter tracer;
+        if (trace)
         {
-            quit = platform.ProcessInput(chip8.keypad);
+            if (tracer.Open(trace) != 0)
+                return EXIT_FAILURE;
+            chip8.set_tracer(&tracer);
+        }
+        // Frames the writer cannot keep up with are dropped, never waited for
+        FrameSink sink;
+        if (video)
+        {
+            FrameSink::Options options;
+            options.format = videoFormat(video);
+            if (sink.Open(video, options) != 0)
+                return EXIT_FAILURE;
+        }
 
-            auto currentTime = std::chrono::high_resolution_clock::now();
-            auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lastCycleTime).count();
+        if (!mute)
+        {
+            AudioStream::Options options;
+            if (audioBuffer)
+                options.bufferSamples = static_cast<unsigned int>(std::stoul(audioBuffer));
+            if (options.bufferSamples == 0 || options.bufferSamples > 8192)
+                throw std::invalid_argument("Audio buffer must be 1-8192 samples");
+            platform.OpenAudio(audio, options);
+        }
 
-            if (delta >= cycleDelay)
+        Timings timings;
+        if (threaded)
+            runThreaded(platform, chip8, recorder, sink, audio, vsync, timings);
+        else
+            runPaced(platform, chip8, recorder, sink, audio, instructionsPerSecond, vsync, timings);
+        platform.CloseAudio();
+        if (recorder.IsOpen() && recorder.Close(chip8.get_cycles()) != 0)
+            return EXIT_FAILURE;
+        chip8.set_tracer(nullptr);
+        if (tracer.Close() != 0 || sink.Close() != 0)
+            return EXIT_FAILURE;
+        if (sink.Dropped())
+            std::cerr << "Video: the writer fell behind, " << sink.Dropped() << " of " << sink.Frames()
+                      << " frames were repeats of the one before\n";
+
+        if (stats)
+        {
+            timings.frames.Print(std::cout, "frame interval");
+            timings.emulation.Print(std::cout, "emulation burst");
+            platform.InputLatency().Print(std::cout, "input latency");
+            if (audio.IsOpen())
             {
-                lastCycleTime = currentTime;
-                chip8.cycle();
-                platform.Update(chip8.video, videoPitch);
+                std::cout << "audio: " << audio.GetOptions().sampleRate << " Hz, "
+                          << audio.GetOptions().bufferSamples << "-sample buffer, " << audio.Underruns()
+                          << " underruns, " << audio.Dropped() << " frames dropped\n";
             }
-
-            SDL_Delay(1);
         }
     }
     catch (const std::exception &e)
@@ -6,16 +6,19 @@
  * Description: Implements all the OPcodes
  *****************************************************************************/
 
+#include "Profiler.hpp"
 #include "chip8.hpp"
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 
-void Processor::OP_00E0()
+void Processor::OP_00E0(const Instr &)
 {
-    std::memset(video, 0, sizeof(video));
+    Display::Clear(display_word(), planes);
+    mark_display_changed();
 }
 
-void Processor::OP_00EE()
+void Processor::OP_00EE(const Instr &)
 {
     if (stack_pointer == 0)
         return;
@@ -23,271 +26,776 @@ void Processor::OP_00EE()
     pc = stack[stack_pointer];
 }
 
-void Processor::OP_1nnn()
+void Processor::OP_1nnn(const Instr &in)
 {
-    pc = opcode & 0x0FFFu;
+    pc = in.nnn;
 }
 
-void Processor::OP_2nnn()
+void Processor::OP_2nnn(const Instr &in)
 {
     if (stack_pointer >= STACK_SIZE)
         return;
     stack[stack_pointer++] = pc;
-    pc = opcode & 0x0FFFu;
+    pc = in.nnn;
 }
 
-void Processor::OP_3xnn()
+template <Quirks::Profile P>
+void Processor::skip_next()
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t nn = opcode & 0x00FFu;
-    if (registers[x] == nn)
-        pc += 2;
+    if constexpr (Quirks::Of(P).longSkips)
+    {
+        constexpr unsigned int mask = Quirks::MemoryBytes(Quirks::Of(P)) - 1;
+        unsigned int address = pc & mask;
+        if (memory[address] == 0xF0 && memory[(address + 1) & mask] == 0x00)
+            pc += 2;
+    }
+    pc += 2;
 }
 
-void Processor::OP_4xnn()
+template <Quirks::Profile P>
+void Processor::OP_3xnn(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t nn = opcode & 0x00FFu;
-    if (registers[x] != nn)
-        pc += 2;
+    if (registers[in.x] == in.nn)
+        skip_next<P>();
 }
 
-void Processor::OP_5xy0()
+template <Quirks::Profile P>
+void Processor::OP_4xnn(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t y = (opcode & 0x00F0u) >> 4u;
-    if (registers[x] == registers[y])
-        pc += 2;
+    if (registers[in.x] != in.nn)
+        skip_next<P>();
 }
 
-void Processor::OP_6xnn()
+template <Quirks::Profile P>
+void Processor::OP_5xy0(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    registers[x] = opcode & 0x00FFu;
+    if (registers[in.x] == registers[in.y])
+        skip_next<P>();
 }
 
-void Processor::OP_7xnn()
+void Processor::OP_6xnn(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    registers[x] += opcode & 0x00FFu;
+    registers[in.x] = in.nn;
 }
 
-void Processor::OP_8xy0()
+void Processor::OP_7xnn(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t y = (opcode & 0x00F0u) >> 4u;
-    registers[x] = registers[y];
+    registers[in.x] += in.nn;
 }
-void Processor::OP_8xy1()
+
+void Processor::OP_8xy0(const Instr &in)
+{
+    registers[in.x] = registers[in.y];
+}
+template <Quirks::Profile P>
+void Processor::OP_8xy1(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t y = (opcode & 0x00F0u) >> 4u;
-    registers[x] |= registers[y];
+    registers[in.x] |= registers[in.y];
+    if constexpr (Quirks::Of(P).logicResetsVf)
+        registers[0xF] = 0;
 }
-void Processor::OP_8xy2()
+template <Quirks::Profile P>
+void Processor::OP_8xy2(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t y = (opcode & 0x00F0u) >> 4u;
-    registers[x] &= registers[y];
+    registers[in.x] &= registers[in.y];
+    if constexpr (Quirks::Of(P).logicResetsVf)
+        registers[0xF] = 0;
 }
-void Processor::OP_8xy3()
+template <Quirks::Profile P>
+void Processor::OP_8xy3(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t y = (opcode & 0x00F0u) >> 4u;
-    registers[x] ^= registers[y];
+    registers[in.x] ^= registers[in.y];
+    if constexpr (Quirks::Of(P).logicResetsVf)
+        registers[0xF] = 0;
 }
-void Processor::OP_8xy4()
+void Processor::OP_8xy4(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t y = (opcode & 0x00F0u) >> 4u;
-    uint16_t sum = registers[x] + registers[y];
+    uint16_t sum = registers[in.x] + registers[in.y];
     registers[0xF] = sum > 0xFF;
-    registers[x] = static_cast<uint8_t>(sum);
+    registers[in.x] = static_cast<uint8_t>(sum);
 }
-void Processor::OP_8xy5()
+void Processor::OP_8xy5(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t y = (opcode & 0x00F0u) >> 4u;
-    registers[0xF] = registers[x] >= registers[y];
-    registers[x] -= registers[y];
+    registers[0xF] = registers[in.x] >= registers[in.y];
+    registers[in.x] -= registers[in.y];
 }
-void Processor::OP_8xy6()
+template <Quirks::Profile P>
+void Processor::OP_8xy6(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    registers[0xF] = registers[x] & 0x1u;
-    registers[x] >>= 1;
+    uint8_t source = registers[Quirks::Of(P).shiftUsesVy ? in.y : in.x];
+    registers[0xF] = source & 0x1u;
+    registers[in.x] = source >> 1;
 }
 
-void Processor::OP_8xy7()
+void Processor::OP_8xy7(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t y = (opcode & 0x00F0u) >> 4u;
-    registers[0xF] = registers[y] >= registers[x];
-    registers[x] = registers[y] - registers[x];
+    registers[0xF] = registers[in.y] >= registers[in.x];
+    registers[in.x] = registers[in.y] - registers[in.x];
 }
 
-void Processor::OP_8xyE()
+template <Quirks::Profile P>
+void Processor::OP_8xyE(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    registers[0xF] = (registers[x] & 0x80u) >> 7u;
-    registers[x] <<= 1;
+    uint8_t source = registers[Quirks::Of(P).shiftUsesVy ? in.y : in.x];
+    registers[0xF] = (source & 0x80u) >> 7u;
+    registers[in.x] = static_cast<uint8_t>(source << 1);
 }
 
-void Processor::OP_9xy0()
+template <Quirks::Profile P>
+void Processor::OP_9xy0(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t y = (opcode & 0x00F0u) >> 4u;
-    if (registers[x] != registers[y])
-        pc += 2;
+    if (registers[in.x] != registers[in.y])
+        skip_next<P>();
 }
 
-void Processor::OP_Annn()
+void Processor::OP_Annn(const Instr &in)
 {
-    index = opcode & 0x0FFFu;
+    index = in.nnn;
 }
 
-void Processor::OP_Bnnn()
+template <Quirks::Profile P>
+void Processor::OP_Bnnn(const Instr &in)
 {
-    pc = (opcode & 0x0FFFu) + registers[0];
+    pc = (in.nnn) + registers[Quirks::Of(P).jumpUsesVx ? in.x : 0];
 }
 
-void Processor::OP_Cxnn()
+void Processor::OP_Cxnn(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t byte = opcode & 0x00FFu;
-    registers[x] = randGen() & byte;
+    registers[in.x] = randGen() & in.nn;
+    ++side_effects;
 }
 
-void Processor::OP_Dxyn()
+template <Quirks::Profile P>
+void Processor::OP_Dxyn(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t y = (opcode & 0x00F0u) >> 4u;
-    uint8_t height = opcode & 0x000Fu;
-    uint8_t x_pos = registers[x] % VIDEO_WIDTH;
-    uint8_t y_pos = registers[y] % VIDEO_HEIGHT;
-
     registers[0xF] = 0;
+    ++generation;
 
-    for (uint8_t row = 0; row < height; ++row)
-    {
-        if (index + row >= MEM_SIZE_BYTES)
-            break;
-        uint8_t sprite = memory[index + row];
-
-        for (uint8_t col = 0; col < 8; ++col)
-        {
-            uint8_t px = x_pos + col;
-            uint8_t py = y_pos + row;
-            if (px >= VIDEO_WIDTH || py >= VIDEO_HEIGHT)
-                continue;
+    // Without big sprites, DXY0 only counts as a draw in high resolution
+    if (in.n == 0 && !hires && !Quirks::Of(P).bigLoresSprites)
+        return;
 
-            uint32_t &pixel = video[py * VIDEO_WIDTH + px];
-            if (sprite & (0x80u >> col))
-            {
-                if (pixel)
-                    registers[0xF] = 1;
-                pixel ^= 0xFFFFFFFF;
-            }
-        }
-    }
+    auto byte = [this](unsigned int address) -> unsigned int { return memory[address]; };
+    if (Display::Draw<Quirks::Of(P).spritesWrap>(display_word(), byte, Quirks::MemoryBytes(Quirks::Of(P)), hires, planes,
+                                                 index, registers[in.x], registers[in.y], in.n,
+                                                 dirty_rows))
+        registers[0xF] = 1;
 }
 
-void Processor::OP_Ex9e()
+template <Quirks::Profile P>
+void Processor::OP_Ex9e(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    if (registers[x] < NUM_KEYS && keypad[registers[x]])
-        pc += 2;
+    if (registers[in.x] < NUM_KEYS && keypad[registers[in.x]])
+        skip_next<P>();
 }
 
-void Processor::OP_Exa1()
+template <Quirks::Profile P>
+void Processor::OP_Exa1(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    if (registers[x] < NUM_KEYS && !keypad[registers[x]])
-        pc += 2;
+    if (registers[in.x] < NUM_KEYS && !keypad[registers[in.x]])
+        skip_next<P>();
 }
 
-void Processor::OP_Fx07()
+void Processor::OP_Fx07(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    registers[x] = delay_timer;
+    registers[in.x] = delay_timer;
 }
 
-void Processor::OP_Fx0a()
+void Processor::OP_Fx0a(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
     bool pressed = false;
 
     for (unsigned int i = 0; i < NUM_KEYS; ++i)
     {
         if (keypad[i])
         {
-            registers[x] = i;
+            registers[in.x] = i;
             pressed = true;
             break;
         }
     }
 
     if (!pressed)
+    {
         pc -= 2;
+        CHIP8_PROFILE_KEY_WAIT();
+    }
 }
 
-void Processor::OP_Fx15()
+void Processor::OP_Fx15(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    delay_timer = registers[x];
+    delay_timer = registers[in.x];
 }
 
-void Processor::OP_Fx18()
+void Processor::OP_Fx18(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    sound_timer = registers[x];
+    sound_timer = registers[in.x];
 }
 
-void Processor::OP_Fx1e()
+template <Quirks::Profile P>
+void Processor::OP_Fx1e(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    if (index + registers[x] < MEM_SIZE_BYTES)
-        index += registers[x];
+    if (index + registers[in.x] < Quirks::MemoryBytes(Quirks::Of(P)))
+        index += registers[in.x];
 }
 
-void Processor::OP_Fx29()
+void Processor::OP_Fx29(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t digit = registers[x];
+    uint8_t digit = registers[in.x];
     if (digit < 16)
         index = FONTSET_START_ADDRESS + (5 * digit);
 }
 
-void Processor::OP_Fx33()
+void Processor::OP_Fx33(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    uint8_t value = registers[x];
-    memory[index] = value / 100;
-    memory[index + 1] = (value / 10) % 10;
-    memory[index + 2] = value % 10;
+    // Digits that would land past the end of memory are dropped, as FX55 does
+    uint8_t value = registers[in.x];
+    const uint8_t digits[3] = {static_cast<uint8_t>(value / 100), static_cast<uint8_t>((value / 10) % 10),
+                               static_cast<uint8_t>(value % 10)};
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+        if (index + d < memory.Size())
+            memory[index + d] = digits[d];
+    }
+    note_store(3);
 }
 
-void Processor::OP_Fx55()
+template <Quirks::Profile P>
+void Processor::OP_Fx55(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    for (uint8_t i = 0; i <= x; ++i)
+    for (uint8_t i = 0; i <= in.x; ++i)
     {
-        if (index + i < MEM_SIZE_BYTES)
+        if (index + i < Quirks::MemoryBytes(Quirks::Of(P)))
             memory[index + i] = registers[i];
     }
+    note_store(in.x + 1u);
+    if constexpr (Quirks::Of(P).memoryAdvancesI)
+        index += in.x + 1;
 }
 
-void Processor::OP_Fx65()
+template <Quirks::Profile P>
+void Processor::OP_Fx65(const Instr &in)
 {
-    uint8_t x = (opcode & 0x0F00u) >> 8u;
-    for (uint8_t i = 0; i <= x; ++i)
+    for (uint8_t i = 0; i <= in.x; ++i)
     {
-        if (index + i < MEM_SIZE_BYTES)
+        if (index + i < Quirks::MemoryBytes(Quirks::Of(P)))
             registers[i] = memory[index + i];
     }
+    if constexpr (Quirks::Of(P).memoryAdvancesI)
+        index += in.x + 1;
 }
 
-void Processor::OP_NULL()
+void Processor::OP_NULL(const Instr &)
 {
     // Do nothing
 }
+
+void Processor::OP_00Cn(const Instr &in)
+{
+    Display::ScrollVertical(display_word(), hires, planes, in.n);
+    mark_display_changed();
+}
+
+void Processor::OP_00FB(const Instr &)
+{
+    Display::ScrollHorizontal(display_word(), hires, planes, 4);
+    mark_display_changed();
+}
+
+void Processor::OP_00FC(const Instr &)
+{
+    Display::ScrollHorizontal(display_word(), hires, planes, -4);
+    mark_display_changed();
+}
+
+void Processor::OP_00FD(const Instr &)
+{
+    // There is no interpreter to return to; spinning here lets the frontend
+    // keep showing the final screen
+    pc -= 2;
+}
+
+void Processor::OP_00FE(const Instr &)
+{
+    hires = false;
+    Display::Clear(display_word(), (1u << DISPLAY_PLANES) - 1);
+    mark_display_changed();
+}
+
+void Processor::OP_00FF(const Instr &)
+{
+    hires = true;
+    Display::Clear(display_word(), (1u << DISPLAY_PLANES) - 1);
+    mark_display_changed();
+}
+
+void Processor::OP_Fx30(const Instr &in)
+{
+    uint8_t digit = registers[in.x];
+    if (digit < 16)
+        index = BIG_FONTSET_START_ADDRESS + (10 * digit);
+}
+
+void Processor::OP_Fx75(const Instr &in)
+{
+    std::memcpy(flags, registers, in.x + 1u);
+    ++side_effects;
+}
+
+void Processor::OP_Fx85(const Instr &in)
+{
+    std::memcpy(registers, flags, in.x + 1u);
+}
+
+void Processor::OP_00Dn(const Instr &in)
+{
+    Display::ScrollVertical(display_word(), hires, planes, -static_cast<int>(in.n));
+    mark_display_changed();
+}
+
+void Processor::OP_5xy2(const Instr &in)
+{
+    int step = in.x <= in.y ? 1 : -1;
+    unsigned int count = (in.x <= in.y ? in.y - in.x : in.x - in.y) + 1u;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (index + i < memory.Size())
+            memory[index + i] = registers[in.x + step * static_cast<int>(i)];
+    }
+    note_store(count);
+}
+
+void Processor::OP_5xy3(const Instr &in)
+{
+    int step = in.x <= in.y ? 1 : -1;
+    unsigned int count = (in.x <= in.y ? in.y - in.x : in.x - in.y) + 1u;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        if (index + i < memory.Size())
+            registers[in.x + step * static_cast<int>(i)] = memory[index + i];
+    }
+}
+
+void Processor::OP_F000(const Instr &)
+{
+    unsigned int address = pc & memory.Mask();
+    index = static_cast<uint16_t>((memory[address] << 8u) | memory[(address + 1) & memory.Mask()]);
+    pc += 2;
+}
+
+void Processor::OP_Fx01(const Instr &in)
+{
+    planes = in.x & ((1u << DISPLAY_PLANES) - 1);
+}
+
+void Processor::OP_F002(const Instr &)
+{
+    for (unsigned int i = 0; i < sizeof(audio_pattern); ++i)
+        audio_pattern[i] = memory[(index + i) & memory.Mask()];
+}
+
+void Processor::OP_Fx3a(const Instr &in)
+{
+    pitch = registers[in.x];
+}
+
+bool Processor::writes_display(Op op)
+{
+    switch (op)
+    {
+    case Op::OP_00E0: case Op::OP_Dxyn: case Op::OP_00Cn: case Op::OP_00Dn:
+    case Op::OP_00FB: case Op::OP_00FC: case Op::OP_00FE: case Op::OP_00FF:
+        return true;
+    default:
+        return false;
+    }
+}
+
+namespace
+{
+// Which handler serves an opcode. The SUPER-CHIP and XO-CHIP forms match
+// exactly; elsewhere in the 0 group only the low nibble selects.
+constexpr Op classify(uint16_t opcode)
+{
+    const unsigned int x = (opcode & 0x0F00u) >> 8u;
+    const unsigned int n = opcode & 0x000Fu;
+    const unsigned int nn = opcode & 0x00FFu;
+
+    switch ((opcode & 0xF000u) >> 12u)
+    {
+    case 0x0:
+        if ((opcode & 0xFFF0u) == 0x00C0u)
+            return Op::OP_00Cn;
+        if ((opcode & 0xFFF0u) == 0x00D0u)
+            return Op::OP_00Dn;
+        if (opcode == 0x00FBu)
+            return Op::OP_00FB;
+        if (opcode == 0x00FCu)
+            return Op::OP_00FC;
+        if (opcode == 0x00FDu)
+            return Op::OP_00FD;
+        if (opcode == 0x00FEu)
+            return Op::OP_00FE;
+        if (opcode == 0x00FFu)
+            return Op::OP_00FF;
+        if (n == 0x0)
+            return Op::OP_00E0;
+        if (n == 0xE)
+            return Op::OP_00EE;
+        break;
+    case 0x1: return Op::OP_1nnn;
+    case 0x2: return Op::OP_2nnn;
+    case 0x3: return Op::OP_3xnn;
+    case 0x4: return Op::OP_4xnn;
+    case 0x5:
+        if (n == 0x2)
+            return Op::OP_5xy2;
+        if (n == 0x3)
+            return Op::OP_5xy3;
+        return Op::OP_5xy0;
+    case 0x6: return Op::OP_6xnn;
+    case 0x7: return Op::OP_7xnn;
+    case 0x8:
+        switch (n)
+        {
+        case 0x0: return Op::OP_8xy0;
+        case 0x1: return Op::OP_8xy1;
+        case 0x2: return Op::OP_8xy2;
+        case 0x3: return Op::OP_8xy3;
+        case 0x4: return Op::OP_8xy4;
+        case 0x5: return Op::OP_8xy5;
+        case 0x6: return Op::OP_8xy6;
+        case 0x7: return Op::OP_8xy7;
+        case 0xE: return Op::OP_8xyE;
+        }
+        break;
+    case 0x9: return Op::OP_9xy0;
+    case 0xA: return Op::OP_Annn;
+    case 0xB: return Op::OP_Bnnn;
+    case 0xC: return Op::OP_Cxnn;
+    case 0xD: return Op::OP_Dxyn;
+    case 0xE:
+        if (n == 0x1)
+            return Op::OP_Exa1;
+        if (n == 0xE)
+            return Op::OP_Ex9e;
+        break;
+    case 0xF:
+        switch (nn)
+        {
+        case 0x00:
+            if (x == 0)
+                return Op::OP_F000;
+            break;
+        case 0x01: return Op::OP_Fx01;
+        case 0x02:
+            if (x == 0)
+                return Op::OP_F002;
+            break;
+        case 0x07: return Op::OP_Fx07;
+        case 0x0A: return Op::OP_Fx0a;
+        case 0x15: return Op::OP_Fx15;
+        case 0x18: return Op::OP_Fx18;
+        case 0x1E: return Op::OP_Fx1e;
+        case 0x29: return Op::OP_Fx29;
+        case 0x33: return Op::OP_Fx33;
+        case 0x55: return Op::OP_Fx55;
+        case 0x30: return Op::OP_Fx30;
+        case 0x3A: return Op::OP_Fx3a;
+        case 0x65: return Op::OP_Fx65;
+        case 0x75: return Op::OP_Fx75;
+        case 0x85: return Op::OP_Fx85;
+        }
+        break;
+    }
+
+    return Op::OP_NULL;
+}
+
+
+// Every 16-bit word mapped to its handler, built by the compiler. One 64 KiB
+// table is shared by all machines, so fetching needs no per-instance decode
+// cache and self-modifying code needs no invalidation.
+struct OpTable
+{
+    Op ops[0x10000];
+};
+
+constexpr OpTable buildOpTable()
+{
+    OpTable table{};
+    for (unsigned int opcode = 0; opcode < 0x10000; ++opcode)
+        table.ops[opcode] = classify(static_cast<uint16_t>(opcode));
+    return table;
+}
+
+constexpr OpTable OP_TABLE = buildOpTable();
+} // namespace
+
+Instr Processor::decode(uint16_t opcode)
+{
+    Instr in;
+    in.op = OP_TABLE.ops[opcode];
+    in.x = (opcode & 0x0F00u) >> 8u;
+    in.y = (opcode & 0x00F0u) >> 4u;
+    in.n = opcode & 0x000Fu;
+    in.nn = opcode & 0x00FFu;
+    in.nnn = opcode & 0x0FFFu;
+    return in;
+}
+
+template <Quirks::Profile P>
+void Processor::execute(const Instr &in)
+{
+    switch (in.op)
+    {
+    case Op::OP_00E0: OP_00E0(in); break;
+    case Op::OP_00EE: OP_00EE(in); break;
+    case Op::OP_1nnn: OP_1nnn(in); break;
+    case Op::OP_2nnn: OP_2nnn(in); break;
+    case Op::OP_3xnn: OP_3xnn<P>(in); break;
+    case Op::OP_4xnn: OP_4xnn<P>(in); break;
+    case Op::OP_5xy0: OP_5xy0<P>(in); break;
+    case Op::OP_6xnn: OP_6xnn(in); break;
+    case Op::OP_7xnn: OP_7xnn(in); break;
+    case Op::OP_8xy0: OP_8xy0(in); break;
+    case Op::OP_8xy1: OP_8xy1<P>(in); break;
+    case Op::OP_8xy2: OP_8xy2<P>(in); break;
+    case Op::OP_8xy3: OP_8xy3<P>(in); break;
+    case Op::OP_8xy4: OP_8xy4(in); break;
+    case Op::OP_8xy5: OP_8xy5(in); break;
+    case Op::OP_8xy6: OP_8xy6<P>(in); break;
+    case Op::OP_8xy7: OP_8xy7(in); break;
+    case Op::OP_8xyE: OP_8xyE<P>(in); break;
+    case Op::OP_9xy0: OP_9xy0<P>(in); break;
+    case Op::OP_Annn: OP_Annn(in); break;
+    case Op::OP_Bnnn: OP_Bnnn<P>(in); break;
+    case Op::OP_Cxnn: OP_Cxnn(in); break;
+    case Op::OP_Dxyn: OP_Dxyn<P>(in); break;
+    case Op::OP_Ex9e: OP_Ex9e<P>(in); break;
+    case Op::OP_Exa1: OP_Exa1<P>(in); break;
+    case Op::OP_Fx07: OP_Fx07(in); break;
+    case Op::OP_Fx0a: OP_Fx0a(in); break;
+    case Op::OP_Fx15: OP_Fx15(in); break;
+    case Op::OP_Fx18: OP_Fx18(in); break;
+    case Op::OP_Fx1e: OP_Fx1e<P>(in); break;
+    case Op::OP_Fx29: OP_Fx29(in); break;
+    case Op::OP_Fx33: OP_Fx33(in); break;
+    case Op::OP_Fx55: OP_Fx55<P>(in); break;
+    case Op::OP_Fx65: OP_Fx65<P>(in); break;
+    case Op::OP_00Cn: OP_00Cn(in); break;
+    case Op::OP_00FB: OP_00FB(in); break;
+    case Op::OP_00FC: OP_00FC(in); break;
+    case Op::OP_00FD: OP_00FD(in); break;
+    case Op::OP_00FE: OP_00FE(in); break;
+    case Op::OP_00FF: OP_00FF(in); break;
+    case Op::OP_Fx30: OP_Fx30(in); break;
+    case Op::OP_Fx75: OP_Fx75(in); break;
+    case Op::OP_Fx85: OP_Fx85(in); break;
+    case Op::OP_00Dn: OP_00Dn(in); break;
+    case Op::OP_5xy2: OP_5xy2(in); break;
+    case Op::OP_5xy3: OP_5xy3(in); break;
+    case Op::OP_F000: OP_F000(in); break;
+    case Op::OP_Fx01: OP_Fx01(in); break;
+    case Op::OP_F002: OP_F002(in); break;
+    case Op::OP_Fx3a: OP_Fx3a(in); break;
+    default: OP_NULL(in); break;
+    }
+}
+
+// The Jit runs the instructions it does not translate through these
+template void Processor::execute<Quirks::Profile::MODERN>(const Instr &);
+template void Processor::execute<Quirks::Profile::CHIP8>(const Instr &);
+template void Processor::execute<Quirks::Profile::SCHIP>(const Instr &);
+template void Processor::execute<Quirks::Profile::XOCHIP>(const Instr &);
+
+// Kept in this file so the handlers above inline into the dispatch switch
+template <Quirks::Profile P, bool Traced>
+void Processor::cycle_as()
+{
+    if (Traced)
+    {
+        tracer->Keys(executed, keypad_bits());
+        tracer->Event(TraceEvent::STEP, executed);
+    }
+    Instr in = fetch();
+    CHIP8_PROFILE_INSTRUCTION(in.op, pc);
+    pc += 2;
+    execute<P>(in);
+}
+
+template <Quirks::Profile P, bool Traced, bool Predicated>
+RunResult Processor::run_as(uint64_t budget, unsigned int stop_on, const Until *until)
+{
+    RunResult result{Exit::BUDGET, 0};
+    const uint64_t start = executed;
+
+    // Keys may have changed since the last call
+    idle_reset();
+    if (Traced)
+        tracer->Keys(start, keypad_bits());
+
+    while (result.cycles < budget)
+    {
+        if (Predicated)
+        {
+            executed = start + result.cycles;
+            if (until->test(until->context, *this))
+            {
+                result.reason = Exit::PREDICATE;
+                break;
+            }
+        }
+
+        start_frame();
+
+        uint16_t before = pc;
+        Instr in = fetch();
+        CHIP8_PROFILE_INSTRUCTION(in.op, before);
+        pc += 2;
+        execute<P>(in);
+        ++result.cycles;
+
+        bool frame_done = --frame_left == 0;
+        if (frame_done)
+        {
+            // A traced tick is stamped with the count it happened at
+            if (Traced)
+                executed = start + result.cycles;
+            tick_timers();
+        }
+
+        if (stop_on != STOP_NONE)
+        {
+            if (frame_done && (stop_on & STOP_FRAME))
+                result.reason = Exit::FRAME;
+            else if ((stop_on & STOP_DRAW) && writes_display(in.op))
+                result.reason = Exit::DRAW;
+            else if ((stop_on & STOP_KEY_WAIT) && in.op == Op::OP_Fx0a && pc == before)
+                result.reason = Exit::KEY_WAIT;
+            else if ((stop_on & STOP_INVALID) && in.op == Op::OP_NULL)
+                result.reason = Exit::INVALID_OPCODE;
+
+            if (result.reason != Exit::BUDGET)
+                break;
+        }
+
+        // Backward branches (including a blocked Fx0a) may close an idle
+        // loop. The last instruction of the frame is always executed so the
+        // tick above stays the only place timers change.
+        if (!Predicated && pc <= before && frame_left > 1)
+        {
+            uint64_t room = std::min(frame_left - 1, budget - result.cycles);
+            uint64_t skipped = idle_skip(result.cycles, room);
+            if (Traced && skipped)
+                tracer->Event(TraceEvent::SKIP, start + result.cycles, skipped);
+            result.cycles += skipped;
+            result.idle_cycles += skipped;
+            frame_left -= skipped;
+        }
+    }
+
+    executed = start + result.cycles;
+    if (Traced)
+        tracer->Event(TraceEvent::RUN, executed);
+    return result;
+}
+
+void Processor::set_quirks(Quirks::Profile profile)
+{
+    using Quirks::Profile;
+    static const struct
+    {
+        RunFn run;
+        RunFn until;
+        CycleFn cycle;
+    } INTERPRETERS[][static_cast<size_t>(Profile::COUNT)] = {
+        {
+            {&Processor::run_as<Profile::MODERN, false, false>, &Processor::run_as<Profile::MODERN, false, true>,
+             &Processor::cycle_as<Profile::MODERN, false>},
+            {&Processor::run_as<Profile::CHIP8, false, false>, &Processor::run_as<Profile::CHIP8, false, true>,
+             &Processor::cycle_as<Profile::CHIP8, false>},
+            {&Processor::run_as<Profile::SCHIP, false, false>, &Processor::run_as<Profile::SCHIP, false, true>,
+             &Processor::cycle_as<Profile::SCHIP, false>},
+            {&Processor::run_as<Profile::XOCHIP, false, false>, &Processor::run_as<Profile::XOCHIP, false, true>,
+             &Processor::cycle_as<Profile::XOCHIP, false>},
+        },
+        {
+            {&Processor::run_as<Profile::MODERN, true, false>, &Processor::run_as<Profile::MODERN, true, true>,
+             &Processor::cycle_as<Profile::MODERN, true>},
+            {&Processor::run_as<Profile::CHIP8, true, false>, &Processor::run_as<Profile::CHIP8, true, true>,
+             &Processor::cycle_as<Profile::CHIP8, true>},
+            {&Processor::run_as<Profile::SCHIP, true, false>, &Processor::run_as<Profile::SCHIP, true, true>,
+             &Processor::cycle_as<Profile::SCHIP, true>},
+            {&Processor::run_as<Profile::XOCHIP, true, false>, &Processor::run_as<Profile::XOCHIP, true, true>,
+             &Processor::cycle_as<Profile::XOCHIP, true>},
+        },
+    };
+    static_assert(sizeof(INTERPRETERS[0]) / sizeof(INTERPRETERS[0][0]) == static_cast<size_t>(Profile::COUNT),
+                  "INTERPRETERS must cover every Profile");
+
+    size_t i = static_cast<size_t>(profile);
+    if (i >= static_cast<size_t>(Profile::COUNT))
+        i = static_cast<size_t>(Profile::MODERN);
+
+    quirks = static_cast<Profile>(i);
+    memory.SetSize(Quirks::MemoryBytes(Quirks::Of(quirks)));
+    trace_keyframe();
+    if (rom_end > memory.Size())
+        std::cerr << "Loaded ROM does not fit the " << Quirks::Name(quirks) << " profile: "
+                  << rom_end - memory.Size() << " bytes past " << memory.Size() << " are unreachable\n";
+    run_fn = INTERPRETERS[tracer != nullptr][i].run;
+    until_fn = INTERPRETERS[tracer != nullptr][i].until;
+    cycle_fn = INTERPRETERS[tracer != nullptr][i].cycle;
+}
+
+void Processor::set_tracer(TraceWriter *writer)
+{
+    tracer = writer;
+    set_quirks(quirks);
+}
+
+uint64_t Processor::idle_probe_loop(uint64_t clock, uint64_t room)
+{
+    static_assert(sizeof(IdleState) == 64, "IdleState is compared with memcmp and must have no padding");
+
+    IdleState now;
+    std::memcpy(now.registers, registers, sizeof(registers));
+    std::memcpy(now.stack, stack, sizeof(stack));
+    now.index = index;
+    now.pc = pc;
+    now.stack_pointer = stack_pointer;
+    now.delay_timer = delay_timer;
+    now.sound_timer = sound_timer;
+    now.unused = 0;
+    now.generation = generation;
+    now.side_effects = side_effects;
+
+    // Compare against the very next backward branch
+    idle_countdown = 1;
+
+    if (!idle_armed)
+    {
+        idle_probe = now;
+        idle_clock = clock;
+        idle_armed = true;
+        idle_matched = false;
+        return 0;
+    }
+
+    if (std::memcmp(&now, &idle_probe, sizeof(now)) != 0)
+    {
+        // Busy loop: back off before the next snapshot
+        idle_matched = false;
+        idle_reset();
+        return 0;
+    }
+
+    // Every further iteration ends in this same state, so whole iterations
+    // can be skipped; the remainder runs normally
+    uint64_t period = clock - idle_clock;
+    uint64_t skipped = room / period * period;
+    idle_clock = clock + skipped;
+    idle_matched = true;
+    return skipped;
+}
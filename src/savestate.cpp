@@ -0,0 +1,360 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Implements save states
+ *
+ * Layout (all integers little-endian, no padding):
+ *   "C8ST"            magic
+ *   u16               format version
+ *   u8[16]            V0..VF
+ *   u16               index
+ *   u16               pc
+ *   u8                stack pointer
+ *   u16[16]           stack
+ *   u8, u8            delay timer, sound timer
+ *   u16               keypad, bit k set when key k is down
+ *   u64[2][64][2]     display words, plane/row/word as in Display.hpp;
+ *                     versions 1-3: u64[32], plane 0 low-resolution rows
+ *   u64               instructions left in the current frame
+ *   u64, u64          instructions/second and frame carry, as IEEE-754 bits
+ *   u32, u32          first and one past the last byte of memory   version 5+
+ *                     written since reset; every other byte is zero
+ *   u8[end - first]   those bytes; version 4: u8[65536], versions 1-3: u8[4096]
+ *   u8                random engine (0 xoshiro128++, 1 PCG32)     version 2+
+ *   u64, u64          random engine state words                   version 2+
+ *   u8                quirk profile (Quirks::Profile)              version 3+
+ *   u8, u8            high resolution, selected planes            version 4+
+ *   u8[16]            flag registers (FX75/FX85)                  version 4+
+ *   u8[16], u8        audio pattern, pitch                        version 4+
+ *
+ * Older versions are still accepted; fields they lack keep the loading
+ * machine's settings.
+ *****************************************************************************/
+
+#include "chip8.hpp"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace
+{
+const char STATE_MAGIC[4] = {'C', '8', 'S', 'T'};
+const uint16_t STATE_VERSION = 5;
+const size_t LEGACY_MEM_SIZE_BYTES = 4096; // Memory size before version 4
+
+class StateWriter
+{
+  public:
+    explicit StateWriter(std::vector<uint8_t> &out) : out(out) {}
+
+    void u8(uint8_t v) { out.push_back(v); }
+    void u16(uint16_t v)
+    {
+        for (int i = 0; i < 2; ++i)
+            out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+    void u32(uint32_t v)
+    {
+        for (int i = 0; i < 4; ++i)
+            out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+    void u64(uint64_t v)
+    {
+        for (int i = 0; i < 8; ++i)
+            out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+    void f64(double v)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        u64(bits);
+    }
+    void bytes(const void *data, size_t size)
+    {
+        const auto *p = static_cast<const uint8_t *>(data);
+        out.insert(out.end(), p, p + size);
+    }
+
+  private:
+    std::vector<uint8_t> &out;
+};
+
+// Reads past the end leave `ok` false and yield zeros
+class StateReader
+{
+  public:
+    StateReader(const uint8_t *data, size_t size) : p(data), end(data + size) {}
+
+    bool ok() const { return good; }
+
+    uint8_t u8()
+    {
+        if (!take(1))
+            return 0;
+        return p[-1];
+    }
+    uint16_t u16()
+    {
+        if (!take(2))
+            return 0;
+        return static_cast<uint16_t>(p[-2] | (p[-1] << 8));
+    }
+    uint32_t u32()
+    {
+        if (!take(4))
+            return 0;
+        uint32_t v = 0;
+        for (int i = 0; i < 4; ++i)
+            v |= static_cast<uint32_t>(p[i - 4]) << (8 * i);
+        return v;
+    }
+    uint64_t u64()
+    {
+        if (!take(8))
+            return 0;
+        uint64_t v = 0;
+        for (int i = 0; i < 8; ++i)
+            v |= static_cast<uint64_t>(p[i - 8]) << (8 * i);
+        return v;
+    }
+    double f64()
+    {
+        uint64_t bits = u64();
+        double v;
+        std::memcpy(&v, &bits, sizeof(v));
+        return v;
+    }
+    void bytes(void *dst, size_t size)
+    {
+        if (take(size))
+            std::memcpy(dst, p - size, size);
+    }
+
+  private:
+    bool take(size_t size)
+    {
+        if (!good || static_cast<size_t>(end - p) < size)
+        {
+            good = false;
+            return false;
+        }
+        p += size;
+        return true;
+    }
+
+    const uint8_t *p;
+    const uint8_t *end;
+    bool good{true};
+};
+} // namespace
+
+std::vector<uint8_t> Processor::save_state() const
+{
+    uint32_t first = memory.Empty() ? 0 : memory.WrittenFirst();
+    uint32_t end = memory.Empty() ? 0 : memory.WrittenEnd();
+
+    std::vector<uint8_t> out;
+    out.reserve(sizeof(display) + (end - first) + 512);
+    StateWriter w(out);
+
+    w.bytes(STATE_MAGIC, sizeof(STATE_MAGIC));
+    w.u16(STATE_VERSION);
+    w.bytes(registers, sizeof(registers));
+    w.u16(index);
+    w.u16(pc);
+    w.u8(stack_pointer);
+    for (uint16_t entry : stack)
+        w.u16(entry);
+    w.u8(delay_timer);
+    w.u8(sound_timer);
+
+    w.u16(keypad_bits());
+
+    for (const auto &plane : display)
+    {
+        for (const auto &row : plane)
+        {
+            for (uint64_t word : row)
+                w.u64(word);
+        }
+    }
+    w.u64(frame_left);
+    w.f64(scheduler.InstructionsPerSecond());
+    w.f64(scheduler.Carry());
+    w.u32(first);
+    w.u32(end);
+    w.bytes(memory.Bytes() + first, end - first);
+    w.u8(static_cast<uint8_t>(rng.GetEngine()));
+    w.u64(rng.State(0));
+    w.u64(rng.State(1));
+    w.u8(static_cast<uint8_t>(quirks));
+    w.u8(hires);
+    w.u8(planes);
+    w.bytes(flags, sizeof(flags));
+    w.bytes(audio_pattern, sizeof(audio_pattern));
+    w.u8(pitch);
+    return out;
+}
+
+int Processor::load_state(const uint8_t *data, size_t size)
+{
+    StateReader r(data, size);
+
+    char magic[sizeof(STATE_MAGIC)];
+    r.bytes(magic, sizeof(magic));
+    uint16_t version = r.u16();
+    if (!r.ok() || std::memcmp(magic, STATE_MAGIC, sizeof(magic)) != 0)
+    {
+        std::cerr << "Not a CHIP-8 save state\n";
+        return 1;
+    }
+    if (version == 0 || version > STATE_VERSION)
+    {
+        std::cerr << "Unsupported save state version: " << version << "\n";
+        return 1;
+    }
+
+    // Decode into a scratch copy so a truncated file leaves this one
+    // untouched. The copy is not traced; the tracer comes back afterwards
+    // and records the loaded state.
+    TraceWriter *writer = tracer;
+    Processor loaded(*this);
+    loaded.tracer = nullptr;
+    r.bytes(loaded.registers, sizeof(loaded.registers));
+    loaded.index = r.u16();
+    loaded.pc = r.u16();
+    loaded.stack_pointer = r.u8();
+    for (uint16_t &entry : loaded.stack)
+        entry = r.u16();
+    loaded.delay_timer = r.u8();
+    loaded.sound_timer = r.u8();
+
+    uint16_t keys = r.u16();
+    for (unsigned int k = 0; k < NUM_KEYS; ++k)
+        loaded.keypad[k] = (keys >> k) & 1u;
+
+    std::memset(loaded.display, 0, sizeof(loaded.display));
+    if (version >= 4)
+    {
+        for (auto &plane : loaded.display)
+        {
+            for (auto &row : plane)
+            {
+                for (uint64_t &word : row)
+                    word = r.u64();
+            }
+        }
+    }
+    else
+    {
+        for (unsigned int y = 0; y < VIDEO_HEIGHT; ++y)
+            loaded.display[0][y][0] = r.u64();
+    }
+    loaded.frame_left = r.u64();
+    double ips = r.f64();
+    double carry = r.f64();
+    bool memoryValid = true;
+    loaded.memory.Clear();
+    if (version >= 5)
+    {
+        uint32_t first = r.u32();
+        uint32_t end = r.u32();
+        memoryValid = first <= end && end <= Memory::MAX_BYTES;
+        if (memoryValid && first < end)
+        {
+            loaded.memory.Reserve(end);
+            r.bytes(&loaded.memory[first], end - first);
+            loaded.memory.NoteWritten(first, end);
+        }
+    }
+    else
+    {
+        uint32_t bytes = version == 4 ? Memory::MAX_BYTES : LEGACY_MEM_SIZE_BYTES;
+        loaded.memory.Reserve(bytes);
+        r.bytes(loaded.memory.Bytes(), bytes);
+        loaded.memory.NoteWritten(0, bytes);
+    }
+
+    bool engineValid = true;
+    if (version >= 2)
+    {
+        uint8_t engine = r.u8();
+        uint64_t word0 = r.u64();
+        uint64_t word1 = r.u64();
+        engineValid = engine <= static_cast<uint8_t>(Random::Engine::PCG);
+        loaded.rng.Restore(static_cast<Random::Engine>(engine), word0, word1);
+    }
+
+    bool quirksValid = true;
+    if (version >= 3)
+    {
+        uint8_t profile = r.u8();
+        quirksValid = profile < static_cast<uint8_t>(Quirks::Profile::COUNT);
+        loaded.set_quirks(static_cast<Quirks::Profile>(profile));
+    }
+
+    // Older machines were always in plain low-resolution CHIP-8 mode
+    loaded.hires = false;
+    loaded.planes = 1;
+    std::memset(loaded.flags, 0, sizeof(loaded.flags));
+    std::memset(loaded.audio_pattern, 0, sizeof(loaded.audio_pattern));
+    loaded.pitch = 64;
+    if (version >= 4)
+    {
+        loaded.hires = r.u8() != 0;
+        loaded.planes = r.u8();
+        r.bytes(loaded.flags, sizeof(loaded.flags));
+        r.bytes(loaded.audio_pattern, sizeof(loaded.audio_pattern));
+        loaded.pitch = r.u8();
+    }
+
+    if (!r.ok() || loaded.stack_pointer > STACK_SIZE || !(ips > 0) || !memoryValid || !engineValid ||
+        !quirksValid || loaded.planes >= (1u << DISPLAY_PLANES))
+    {
+        std::cerr << "Corrupt or truncated save state\n";
+        return 1;
+    }
+
+    loaded.scheduler = Scheduler(ips, carry);
+    loaded.dirty_rows = ~0ull;
+    ++loaded.generation;
+
+    *this = loaded;
+    set_tracer(writer);
+    return 0;
+}
+
+int Processor::save_state(const char *filename) const
+{
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open save state for writing: " << filename << "\n";
+        return 1;
+    }
+
+    std::vector<uint8_t> state = save_state();
+    file.write(reinterpret_cast<const char *>(state.data()), static_cast<std::streamsize>(state.size()));
+    if (!file)
+    {
+        std::cerr << "Error writing save state: " << filename << "\n";
+        return 1;
+    }
+    return 0;
+}
+
+int Processor::load_state(const char *filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Failed to open save state: " << filename << "\n";
+        return 1;
+    }
+
+    std::vector<uint8_t> state((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return load_state(state.data(), state.size());
+}
@@ -0,0 +1,348 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Headless batch runner, runs many ROM instances on every core
+ *****************************************************************************/
+
+#include "Jit.hpp"
+#include "ProcessorBatch.hpp"
+#include "RomCatalog.hpp"
+#include "ThreadPool.hpp"
+#include "chip8.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct RomJob
+{
+    std::string path;
+    std::vector<uint8_t> image; // Holds a ROM read on its own; catalog ROMs stay mapped
+    const uint8_t *data;
+    size_t size;
+    unsigned int count;
+    Quirks::Profile quirks;
+    ControlFlow::Graph graph; // Blocks the JIT translates before the first run
+};
+
+struct InstanceResult
+{
+    uint64_t cycles;
+    uint64_t idleCycles; // Fast-forwarded through idle loops
+    double seconds;
+    uint64_t videoHash;
+    uint64_t stateHash;
+};
+
+void usage(const char *argv0)
+{
+    std::cerr << "Usage: " << argv0
+              << " [-n cycles] [-s ips] [-j threads] [-J | -L lanes] [-S seed] [-R engine]\n"
+              << "       [-Q quirks] [-q] <ROM|directory>[:count] ...\n"
+              << "  -n cycles   instructions to run per instance (default 1000000)\n"
+              << "  -s ips      emulated instructions per second, sets how often the\n"
+              << "              60 Hz timers tick (default 700)\n"
+              << "  -j threads  worker threads (default: all cores)\n"
+              << "  -J          execute through the x86-64 JIT\n"
+              << "  -L lanes    run instances of a ROM in lockstep, up to `lanes` per\n"
+              << "              vectorized ProcessorBatch\n"
+              << "  -S seed     seed the random engines: instance n of each ROM starts\n"
+              << "              from seed + n, so runs repeat exactly (default: random)\n"
+              << "  -R engine   random engine for CXNN, xoshiro or pcg (default xoshiro)\n"
+              << "  -Q quirks   modern, chip8, schip, xochip, or auto to pick per ROM\n"
+              << "              (default modern)\n"
+              << "  -q          only print the aggregate summary\n"
+              << "A directory runs every ROM in it through a cached RomCatalog.\n";
+}
+
+// Splits "path:count"; a missing or non-numeric suffix means a single instance
+RomJob parseRomArg(const std::string &arg)
+{
+    RomJob job{arg, {}, nullptr, 0, 1, Quirks::Profile::MODERN, {}};
+    size_t colon = arg.rfind(':');
+    if (colon != std::string::npos && colon + 1 < arg.size() &&
+        arg.find_first_not_of("0123456789", colon + 1) == std::string::npos)
+    {
+        job.path = arg.substr(0, colon);
+        job.count = static_cast<unsigned int>(std::stoul(arg.substr(colon + 1)));
+    }
+    return job;
+}
+
+bool readRom(RomJob &job)
+{
+    std::ifstream rom(job.path, std::ios::binary);
+    if (!rom.is_open())
+    {
+        std::cerr << "Failed to open ROM: " << job.path << "\n";
+        return false;
+    }
+    job.image.assign(std::istreambuf_iterator<char>(rom), std::istreambuf_iterator<char>());
+    job.data = job.image.data();
+    job.size = job.image.size();
+    return true;
+}
+
+uint64_t hashVideo(const Processor &chip8)
+{
+    // FNV-1a over the framebuffer
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const auto *bytes = reinterpret_cast<const uint8_t *>(chip8.display);
+    for (size_t i = 0; i < sizeof(chip8.display); ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t cycles = 1000000;
+    double ips = 700;
+    unsigned int threads = 0;
+    bool quiet = false;
+    bool useJit = false;
+    unsigned int lanes = 0;
+    bool seeded = false;
+    uint64_t seed = 0;
+    Random::Engine engine = Random::Engine::XOSHIRO;
+    bool detectQuirks = false;
+    Quirks::Profile quirks = Quirks::Profile::MODERN;
+    std::vector<RomJob> jobs;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "-n" && i + 1 < argc)
+                cycles = std::stoull(argv[++i]);
+            else if (arg == "-s" && i + 1 < argc)
+                ips = std::stod(argv[++i]);
+            else if (arg == "-j" && i + 1 < argc)
+                threads = static_cast<unsigned int>(std::stoul(argv[++i]));
+            else if (arg == "-J")
+                useJit = true;
+            else if (arg == "-L" && i + 1 < argc)
+                lanes = static_cast<unsigned int>(std::stoul(argv[++i]));
+            else if (arg == "-S" && i + 1 < argc)
+            {
+                seed = std::stoull(argv[++i]);
+                seeded = true;
+            }
+            else if (arg == "-R" && i + 1 < argc)
+            {
+                if (!Random::ParseEngine(argv[++i], engine))
+                    throw std::invalid_argument(std::string("unknown random engine ") + argv[i]);
+            }
+            else if (arg == "-Q" && i + 1 < argc)
+            {
+                detectQuirks = std::string(argv[++i]) == "auto";
+                if (!detectQuirks && !Quirks::Parse(argv[i], quirks))
+                    throw std::invalid_argument(std::string("unknown quirk profile ") + argv[i]);
+            }
+            else if (arg == "-q")
+                quiet = true;
+            else if (!arg.empty() && arg[0] == '-')
+            {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            else
+                jobs.push_back(parseRomArg(arg));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Invalid argument: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (jobs.empty() || ips <= 0 || (useJit && lanes > 0))
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Each ROM is read or mapped once and shared read-only by all of its
+    // instances. A directory expands to the ROMs in its catalog, whose
+    // detected profiles come from the index instead of a fresh scan.
+    std::vector<std::unique_ptr<RomCatalog>> catalogs;
+    std::vector<RomJob> expanded;
+    for (auto &job : jobs)
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(job.path, error))
+        {
+            if (!readRom(job))
+                return EXIT_FAILURE;
+            job.quirks = detectQuirks ? Quirks::Detect(job.data, job.size) : quirks;
+            Processor probe;
+            probe.set_quirks(job.quirks);
+            if (probe.load_rom(job.data, job.size) != 0)
+                return EXIT_FAILURE;
+            expanded.push_back(std::move(job));
+            continue;
+        }
+
+        catalogs.push_back(std::make_unique<RomCatalog>());
+        const RomCatalog &catalog = *catalogs.back();
+        if (catalogs.back()->Open(job.path) != 0)
+            return EXIT_FAILURE;
+        if (!quiet)
+        {
+            std::printf("catalog %s roms=%zu analysed=%zu\n", job.path.c_str(), catalog.Roms().size(),
+                        catalog.Analysed());
+        }
+        for (const RomCatalog::Rom &rom : catalog.Roms())
+        {
+            // rom.fits is for the detected profile; -Q may name another
+            Quirks::Profile profile = detectQuirks ? rom.quirks : quirks;
+            bool fits = detectQuirks ? rom.fits
+                                     : rom.size <= Quirks::MemoryBytes(Quirks::Of(profile)) - START_ADDRESS;
+            if (!fits)
+            {
+                std::cerr << "Skipping " << rom.name << ": too large to load\n";
+                continue;
+            }
+            expanded.push_back({(std::filesystem::path(job.path) / rom.name).string(), {}, rom.data, rom.size,
+                                job.count, profile, {}});
+        }
+    }
+    jobs = std::move(expanded);
+    if (jobs.empty())
+    {
+        std::cerr << "No ROMs to run\n";
+        return EXIT_FAILURE;
+    }
+    if (useJit)
+    {
+        for (auto &job : jobs)
+            job.graph = ControlFlow::Analyse(job.data, job.size);
+    }
+
+    std::vector<size_t> firstResult;
+    size_t total = 0;
+    for (const auto &job : jobs)
+    {
+        firstResult.push_back(total);
+        total += job.count;
+    }
+    std::vector<InstanceResult> results(total);
+
+    ThreadPool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t j = 0; j < jobs.size() && lanes > 0; ++j)
+    {
+        // Lockstep: each task runs a slice of this ROM's instances as lanes
+        for (unsigned int first = 0; first < jobs[j].count; first += lanes)
+        {
+            unsigned int width = std::min(lanes, jobs[j].count - first);
+            InstanceResult *slots = &results[firstResult[j] + first];
+            const RomJob *job = &jobs[j];
+            pool.Submit([slots, width, job, cycles, ips, first, seeded, seed, engine]
+                        {
+                auto begin = std::chrono::steady_clock::now();
+                ProcessorBatch batch(width);
+                batch.seed_random(seeded ? seed + first : Random::EntropySeed(), engine);
+                batch.set_quirks(job->quirks);
+                batch.load_rom(job->data, job->size);
+                batch.set_instructions_per_second(ips);
+                batch.run(cycles);
+                auto end = std::chrono::steady_clock::now();
+
+                Processor lane;
+                for (unsigned int l = 0; l < width; ++l)
+                {
+                    batch.store_lane(l, lane);
+                    slots[l].cycles = cycles;
+                    slots[l].idleCycles = 0;
+                    slots[l].seconds = std::chrono::duration<double>(end - begin).count();
+                    slots[l].videoHash = hashVideo(lane);
+                    slots[l].stateHash = lane.state_hash();
+                } });
+        }
+    }
+
+    for (size_t j = 0; j < jobs.size() && lanes == 0; ++j)
+    {
+        for (unsigned int n = 0; n < jobs[j].count; ++n)
+        {
+            InstanceResult *slot = &results[firstResult[j] + n];
+            const RomJob *job = &jobs[j];
+            pool.Submit([slot, job, cycles, ips, useJit, n, seeded, seed, engine]
+                        {
+                auto begin = std::chrono::steady_clock::now();
+                Processor chip8;
+                chip8.seed_random(seeded ? seed + n : Random::EntropySeed(), engine);
+                chip8.set_quirks(job->quirks);
+                chip8.load_rom(job->data, job->size);
+
+                // Emulated time: timers tick once per 60 Hz share of cycles
+                chip8.set_instructions_per_second(ips);
+                RunResult run;
+                if (useJit)
+                {
+                    // About 1 MiB of block tables: too big for a worker's stack
+                    std::unique_ptr<Jit> jit(new Jit(chip8));
+                    jit->prebuild(job->graph);
+                    run = jit->run(cycles);
+                }
+                else
+                {
+                    run = chip8.run(cycles);
+                }
+                auto end = std::chrono::steady_clock::now();
+
+                slot->cycles = run.cycles;
+                slot->idleCycles = run.idle_cycles;
+                slot->seconds = std::chrono::duration<double>(end - begin).count();
+                slot->videoHash = hashVideo(chip8);
+                slot->stateHash = chip8.state_hash(); });
+        }
+    }
+
+    pool.Wait();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    uint64_t totalCycles = 0;
+    uint64_t totalIdle = 0;
+    for (size_t j = 0; j < jobs.size(); ++j)
+    {
+        for (unsigned int n = 0; n < jobs[j].count; ++n)
+        {
+            const InstanceResult &r = results[firstResult[j] + n];
+            totalCycles += r.cycles;
+            totalIdle += r.idleCycles;
+            if (!quiet)
+            {
+                std::printf("%s #%u cycles=%llu idle=%llu time=%.6fs video=%016llx state=%016llx\n",
+                            jobs[j].path.c_str(), n,
+                            static_cast<unsigned long long>(r.cycles),
+                            static_cast<unsigned long long>(r.idleCycles), r.seconds,
+                            static_cast<unsigned long long>(r.videoHash),
+                            static_cast<unsigned long long>(r.stateHash));
+            }
+        }
+    }
+
+    std::printf("instances=%zu threads=%u cycles=%llu idle=%llu wall=%.3fs ips=%.0f\n",
+                total, pool.Size(), static_cast<unsigned long long>(totalCycles),
+                static_cast<unsigned long long>(totalIdle), wall, wall > 0 ? totalCycles / wall : 0.0);
+
+    return EXIT_SUCCESS;
+}
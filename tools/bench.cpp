@@ -0,0 +1,413 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Benchmark suite: synthetic per-opcode-class ROMs, recorded
+ *              game sessions, and any ROMs given on the command line
+ *****************************************************************************/
+
+#include "InputLog.hpp"
+#include "Jit.hpp"
+#include "chip8.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Workload
+{
+    std::string name;
+    std::vector<uint8_t> image;
+    // A recorded session is replayed from power-on to its end instead of
+    // running the ROM for a fixed number of instructions
+    std::shared_ptr<InputReplay> session{};
+};
+
+struct Stats
+{
+    double median;
+    double mean;
+    double stddev;
+    double min;
+    double max;
+};
+
+struct Result
+{
+    std::string workload;
+    std::string engine;
+    uint64_t instructions;        // Per timed run
+    Stats nsPerInstruction;
+    double instructionsPerSecond; // From the median run
+    double drawsPerSecond;        // From the median run
+};
+
+std::vector<uint8_t> assemble(std::initializer_list<uint16_t> words)
+{
+    std::vector<uint8_t> image;
+    for (uint16_t w : words)
+    {
+        image.push_back(static_cast<uint8_t>(w >> 8));
+        image.push_back(static_cast<uint8_t>(w));
+    }
+    return image;
+}
+
+// Each synthetic ROM is an endless loop that leans on one class of opcodes
+std::vector<Workload> syntheticWorkloads()
+{
+    std::vector<Workload> workloads;
+
+    // Register arithmetic with carries, borrows and shifts
+    workloads.push_back({"alu", assemble({
+                                    0x6001, 0x6103, 0x6207, 0x630F,                 // 200: seed V0-V3
+                                    0x8014, 0x8125, 0x8236, 0x8317, 0x834E,         // 208: 8xy4/5/6/7/E
+                                    0x8401, 0x8512, 0x8623, 0x7001, 0x7103,         // 212: OR/AND/XOR/ADD
+                                    0x1208,                                         // 21C: loop
+                                })});
+
+    // Conditional skips, calls and returns
+    workloads.push_back({"branch", assemble({
+                                       0x6000, 0x6105,         // 200: V0 = 0, V1 = 5
+                                       0x7001,                 // 204: V0 += 1
+                                       0x3005,                 // 206: skip if V0 == 5
+                                       0x4100,                 // 208: skip if V1 != 0
+                                       0x6000,                 // 20A: (skipped)
+                                       0x5010,                 // 20C: skip if V0 == V1
+                                       0x2218,                 // 20E: call 218
+                                       0x9010,                 // 210: skip if V0 != V1
+                                       0x6000,                 // 212: V0 = 0
+                                       0x1204,                 // 214: loop
+                                       0x0000,                 // 216: padding
+                                       0x7201, 0x00EE,         // 218: V2 += 1; return
+                                   })});
+
+    // Sprites marching across the screen with a clear every 256 draws
+    std::vector<uint8_t> draw = assemble({
+        0xA220,                 // 200: I = sprite
+        0x6000, 0x6100,         // 202: V0 = 0, V1 = 0
+        0xD018,                 // 206: draw 8 rows
+        0x7003, 0x7105,         // 208: move
+        0x7201, 0x4200,         // 20C: V2 += 1; skip if V2 != 0
+        0x00E0,                 // 210: clear
+        0x1206,                 // 212: loop
+        0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, // 214: padding to 220
+    });
+    const uint8_t sprite[] = {0xFF, 0x81, 0xBD, 0xA5, 0xA5, 0xBD, 0x81, 0xFF};
+    draw.insert(draw.end(), std::begin(sprite), std::end(sprite));
+    workloads.push_back({"draw", draw});
+
+    // BCD conversion and register block moves through memory
+    workloads.push_back({"memory", assemble({
+                                       0x6500,         // 200: V5 = 0
+                                       0xA300,         // 202: I = 300
+                                       0xF533,         // 204: BCD of V5
+                                       0xF265,         // 206: V0-V2 = digits
+                                       0xF755,         // 208: store V0-V7
+                                       0xF51E,         // 20A: I += V5
+                                       0x7501,         // 20C: V5 += 1
+                                       0x1202,         // 20E: loop
+                                   })});
+
+    return workloads;
+}
+
+bool readRom(const std::string &path, Workload &workload)
+{
+    std::ifstream rom(path, std::ios::binary);
+    if (!rom.is_open())
+    {
+        std::cerr << "Failed to open ROM: " << path << "\n";
+        return false;
+    }
+    workload.name = path;
+    workload.image.assign(std::istreambuf_iterator<char>(rom), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Loads a session and the ROM beside it with the same name and a .ch8
+// extension, which must be the ROM it was recorded with
+bool readSession(const std::string &path, Workload &workload)
+{
+    auto session = std::make_shared<InputReplay>();
+    if (session->Load(path.c_str()) != 0)
+        return false;
+    std::string rom = std::filesystem::path(path).replace_extension(".ch8").string();
+    if (!readRom(rom, workload))
+        return false;
+    const SessionInfo &info = session->Info();
+    if (workload.image.size() != info.romSize ||
+        SessionInfo::HashRom(workload.image.data(), workload.image.size()) != info.romHash)
+    {
+        std::cerr << rom << " is not the ROM " << path << " was recorded with\n";
+        return false;
+    }
+    workload.name = std::filesystem::path(path).stem().string();
+    workload.session = std::move(session);
+    return true;
+}
+
+// Every session in `directory`, by name
+bool readSessions(const std::string &directory, std::vector<Workload> &workloads)
+{
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(directory, error))
+    {
+        if (entry.path().extension() == ".c8ir")
+            paths.push_back(entry.path().string());
+    }
+    if (error)
+    {
+        std::cerr << "No recorded sessions in " << directory << ": " << error.message() << "\n";
+        return true;
+    }
+    std::sort(paths.begin(), paths.end());
+    for (const auto &path : paths)
+    {
+        Workload workload;
+        if (!readSession(path, workload))
+            return false;
+        workloads.push_back(std::move(workload));
+    }
+    return true;
+}
+
+Stats summarize(std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    Stats s{};
+    size_t n = samples.size();
+    s.median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    s.min = samples.front();
+    s.max = samples.back();
+    for (double v : samples)
+        s.mean += v;
+    s.mean /= static_cast<double>(n);
+    for (double v : samples)
+        s.stddev += (v - s.mean) * (v - s.mean);
+    s.stddev = n > 1 ? std::sqrt(s.stddev / static_cast<double>(n - 1)) : 0;
+    return s;
+}
+
+// One timed run from a freshly loaded instance. Returns seconds and draws.
+void timeRun(const Workload &workload, bool useJit, uint64_t cycles, double ips,
+             double &seconds, uint64_t &draws)
+{
+    auto chip8 = std::make_unique<Processor>();
+    chip8->seed_random(0); // Every repeat follows the same path through the ROM
+    chip8->set_instructions_per_second(ips);
+    if (workload.session)
+        workload.session->Info().Apply(*chip8);
+    chip8->load_rom(workload.image.data(), workload.image.size());
+    std::unique_ptr<Jit> jit(useJit ? new Jit(*chip8) : nullptr);
+    uint32_t before = chip8->display_generation();
+
+    auto start = std::chrono::steady_clock::now();
+    if (workload.session && jit)
+        workload.session->Play(*chip8, [&jit](uint64_t n) { jit->run(n); });
+    else if (workload.session)
+        workload.session->Play(*chip8, [&chip8](uint64_t n) { chip8->run(n); });
+    else if (jit)
+        jit->run(cycles);
+    else
+        chip8->run(cycles);
+    auto end = std::chrono::steady_clock::now();
+
+    seconds = std::chrono::duration<double>(end - start).count();
+    draws = chip8->display_generation() - before;
+}
+
+Result measure(const Workload &workload, bool useJit, uint64_t cycles,
+               unsigned int repeats, double ips)
+{
+    double seconds;
+    uint64_t draws;
+    if (workload.session)
+        cycles = workload.session->EndCycle();
+
+    // Untimed warm-up so page faults and first-touch costs are not measured
+    timeRun(workload, useJit, cycles / 10 + 1, ips, seconds, draws);
+
+    std::vector<double> nsPerInstruction;
+    std::vector<double> drawRates;
+    for (unsigned int r = 0; r < repeats; ++r)
+    {
+        timeRun(workload, useJit, cycles, ips, seconds, draws);
+        nsPerInstruction.push_back(seconds * 1e9 / static_cast<double>(cycles));
+        drawRates.push_back(seconds > 0 ? draws / seconds : 0);
+    }
+
+    Result result;
+    result.workload = workload.name;
+    result.engine = useJit ? "jit" : "interpreter";
+    result.instructions = cycles;
+    result.nsPerInstruction = summarize(nsPerInstruction);
+    result.instructionsPerSecond = 1e9 / result.nsPerInstruction.median;
+    result.drawsPerSecond = summarize(drawRates).median;
+    return result;
+}
+
+std::string jsonEscape(const std::string &text)
+{
+    std::string out;
+    for (char c : text)
+    {
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+            out += escaped;
+            continue;
+        }
+        if (c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+bool writeJson(const char *path, const std::vector<Result> &results,
+               uint64_t cycles, unsigned int repeats, double ips)
+{
+    std::FILE *out = std::fopen(path, "w");
+    if (!out)
+    {
+        std::cerr << "Failed to open " << path << " for writing\n";
+        return false;
+    }
+
+    std::fprintf(out, "{\n  \"schema\": 2,\n  \"timestamp\": %lld,\n",
+                 static_cast<long long>(std::time(nullptr)));
+    std::fprintf(out, "  \"cycles\": %llu,\n  \"repeats\": %u,\n  \"instructions_per_second_target\": %.0f,\n",
+                 static_cast<unsigned long long>(cycles), repeats, ips);
+    std::fprintf(out, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const Result &r = results[i];
+        const Stats &s = r.nsPerInstruction;
+        std::fprintf(out,
+                     "    {\"workload\": \"%s\", \"engine\": \"%s\", \"instructions\": %llu, "
+                     "\"ns_per_instruction\": {\"median\": %.4f, \"mean\": %.4f, \"stddev\": %.4f, \"min\": %.4f, \"max\": %.4f}, "
+                     "\"instructions_per_second\": %.0f, \"draws_per_second\": %.0f}%s\n",
+                     jsonEscape(r.workload).c_str(), r.engine.c_str(),
+                     static_cast<unsigned long long>(r.instructions),
+                     s.median, s.mean, s.stddev, s.min, s.max,
+                     r.instructionsPerSecond, r.drawsPerSecond,
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+    return std::fclose(out) == 0;
+}
+
+void usage(const char *argv0)
+{
+    std::cerr << "Usage: " << argv0
+              << " [-n cycles] [-r repeats] [-s ips] [-d dir] [-o results.json] [--no-jit] [ROM|session.c8ir ...]\n"
+              << "  -n cycles   instructions per timed run (default 20000000)\n"
+              << "  -r repeats  timed runs per workload and engine (default 7)\n"
+              << "  -s ips      emulated instructions per second (default 700)\n"
+              << "  -d dir      replay every recorded session in dir (default bench); a\n"
+              << "              session is timed over its whole length at its own speed\n"
+              << "  -o file     also write results as JSON\n"
+              << "  --no-jit    only benchmark the interpreter\n";
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    uint64_t cycles = 20000000;
+    unsigned int repeats = 7;
+    double ips = 700;
+    const char *jsonPath = nullptr;
+    bool withJit = true;
+    std::vector<Workload> workloads = syntheticWorkloads();
+    std::vector<Workload> extra;
+    std::string sessionDir = "bench";
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "-n" && i + 1 < argc)
+                cycles = std::stoull(argv[++i]);
+            else if (arg == "-r" && i + 1 < argc)
+                repeats = static_cast<unsigned int>(std::stoul(argv[++i]));
+            else if (arg == "-s" && i + 1 < argc)
+                ips = std::stod(argv[++i]);
+            else if (arg == "-d" && i + 1 < argc)
+                sessionDir = argv[++i];
+            else if (arg == "-o" && i + 1 < argc)
+                jsonPath = argv[++i];
+            else if (arg == "--no-jit")
+                withJit = false;
+            else if (!arg.empty() && arg[0] == '-')
+            {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            else if (std::filesystem::path(arg).extension() == ".c8ir")
+            {
+                Workload session;
+                if (!readSession(arg, session))
+                    return EXIT_FAILURE;
+                extra.push_back(std::move(session));
+            }
+            else
+            {
+                Workload rom;
+                if (!readRom(arg, rom))
+                    return EXIT_FAILURE;
+                extra.push_back(std::move(rom));
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Invalid argument: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (cycles == 0 || repeats == 0 || ips <= 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!readSessions(sessionDir, workloads))
+        return EXIT_FAILURE;
+    workloads.insert(workloads.end(), extra.begin(), extra.end());
+
+    std::vector<Result> results;
+    std::printf("%-20s %-12s %10s %10s %14s %12s\n",
+                "workload", "engine", "ns/instr", "stddev", "instr/s", "draws/s");
+
+    for (const auto &workload : workloads)
+    {
+        for (int engine = 0; engine < (withJit ? 2 : 1); ++engine)
+        {
+            Result r = measure(workload, engine == 1, cycles, repeats, ips);
+            std::printf("%-20s %-12s %10.3f %10.3f %14.0f %12.0f\n",
+                        r.workload.c_str(), r.engine.c_str(),
+                        r.nsPerInstruction.median, r.nsPerInstruction.stddev,
+                        r.instructionsPerSecond, r.drawsPerSecond);
+            results.push_back(r);
+        }
+    }
+
+    if (jsonPath && !writeJson(jsonPath, results, cycles, repeats, ips))
+        return EXIT_FAILURE;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,149 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Regression checks for decoding, idle-loop detection and
+ *              quirks
+ *****************************************************************************/
+
+#include "Disassembler.hpp"
+#include "chip8.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+// Expected decodings written out by hand from the instruction set, one or
+// more per family plus the words next to them that must stay invalid.
+// Independent of the classifier the decode table is built from, so a bug
+// shared by both still shows up here.
+struct Decoding
+{
+    uint16_t opcode;
+    Op op;
+};
+
+const Decoding DECODINGS[] = {
+    {0x00E0, Op::OP_00E0}, {0x00EE, Op::OP_00EE}, {0x00C5, Op::OP_00Cn}, {0x00D3, Op::OP_00Dn},
+    {0x00FB, Op::OP_00FB}, {0x00FC, Op::OP_00FC}, {0x00FD, Op::OP_00FD}, {0x00FE, Op::OP_00FE},
+    {0x00FF, Op::OP_00FF}, {0x1234, Op::OP_1nnn}, {0x2ABC, Op::OP_2nnn}, {0x3A12, Op::OP_3xnn},
+    {0x4B34, Op::OP_4xnn}, {0x5120, Op::OP_5xy0}, {0x5122, Op::OP_5xy2}, {0x5123, Op::OP_5xy3},
+    {0x6C56, Op::OP_6xnn}, {0x7D78, Op::OP_7xnn}, {0x8120, Op::OP_8xy0}, {0x8121, Op::OP_8xy1},
+    {0x8122, Op::OP_8xy2}, {0x8123, Op::OP_8xy3}, {0x8124, Op::OP_8xy4}, {0x8125, Op::OP_8xy5},
+    {0x8126, Op::OP_8xy6}, {0x8127, Op::OP_8xy7}, {0x812E, Op::OP_8xyE}, {0x8128, Op::OP_NULL},
+    {0x812F, Op::OP_NULL}, {0x9120, Op::OP_9xy0}, {0xA123, Op::OP_Annn}, {0xB456, Op::OP_Bnnn},
+    {0xC1FF, Op::OP_Cxnn}, {0xD125, Op::OP_Dxyn}, {0xE19E, Op::OP_Ex9e}, {0xE1A1, Op::OP_Exa1},
+    {0xE1FF, Op::OP_NULL}, {0xF000, Op::OP_F000}, {0xF100, Op::OP_NULL}, {0xFF00, Op::OP_NULL},
+    {0xF001, Op::OP_Fx01}, {0xF301, Op::OP_Fx01}, {0xF002, Op::OP_F002}, {0xF102, Op::OP_NULL},
+    {0xF007, Op::OP_Fx07}, {0xF507, Op::OP_Fx07}, {0xF10A, Op::OP_Fx0a}, {0xF115, Op::OP_Fx15},
+    {0xF118, Op::OP_Fx18}, {0xF11E, Op::OP_Fx1e}, {0xF129, Op::OP_Fx29}, {0xF130, Op::OP_Fx30},
+    {0xF133, Op::OP_Fx33}, {0xF13A, Op::OP_Fx3a}, {0xF155, Op::OP_Fx55}, {0xF165, Op::OP_Fx65},
+    {0xF175, Op::OP_Fx75}, {0xF185, Op::OP_Fx85}, {0xF108, Op::OP_NULL}, {0xF1FF, Op::OP_NULL},
+};
+
+// Returns the number of failures
+unsigned int checkDecode()
+{
+    unsigned int failures = 0;
+    for (const Decoding &d : DECODINGS)
+    {
+        Op op = Processor::decode(d.opcode).op;
+        if (op != d.op)
+        {
+            if (failures < 10)
+                std::printf("decode %04X: %s, expected %s\n", d.opcode, Disassembler::OpName(op),
+                            Disassembler::OpName(d.op));
+            ++failures;
+        }
+    }
+
+    // Every word, for the operand fields
+    for (unsigned int opcode = 0; opcode < 0x10000; ++opcode)
+    {
+        Instr in = Processor::decode(static_cast<uint16_t>(opcode));
+        bool fields = in.x == ((opcode >> 8) & 0xF) && in.y == ((opcode >> 4) & 0xF) && in.n == (opcode & 0xF) &&
+                      in.nn == (opcode & 0xFF) && in.nnn == (opcode & 0xFFF);
+        if (!fields)
+        {
+            if (failures < 10)
+                std::printf("decode %04X: operand fields\n", opcode);
+            ++failures;
+        }
+    }
+    return failures;
+}
+
+// Runs `rom` for a while and reports how much of it was fast-forwarded
+uint64_t idleCycles(const uint8_t *rom, size_t size)
+{
+    Processor cpu;
+    if (cpu.load_rom(rom, size) != 0)
+        return UINT64_MAX;
+    return cpu.run(100000).idle_cycles;
+}
+
+unsigned int checkIdle()
+{
+    unsigned int failures = 0;
+
+    // A jump to itself does nothing but wait, and must be skipped
+    const uint8_t spin[] = {0x12, 0x00};
+    if (idleCycles(spin, sizeof(spin)) == 0)
+    {
+        std::printf("idle: 1200 was not fast-forwarded\n");
+        ++failures;
+    }
+
+    // Stores to the flag registers are effects, even when every pass stores
+    // the same values
+    const uint8_t saveFlags[] = {0x60, 0x05, 0xF0, 0x75, 0x12, 0x02};
+    if (idleCycles(saveFlags, sizeof(saveFlags)) != 0)
+    {
+        std::printf("idle: a loop of F075 was fast-forwarded\n");
+        ++failures;
+    }
+    return failures;
+}
+
+// FX1E keeps the baseline's 4 KiB bound except on XO-CHIP
+unsigned int checkIndexLimit()
+{
+    const uint8_t rom[] = {0xAF, 0xFF, 0x60, 0x02, 0xF0, 0x1E};
+    unsigned int failures = 0;
+    for (unsigned int p = 0; p < static_cast<unsigned int>(Quirks::Profile::COUNT); ++p)
+    {
+        Quirks::Profile profile = static_cast<Quirks::Profile>(p);
+        Processor cpu;
+        cpu.set_quirks(profile);
+        cpu.load_rom(rom, sizeof(rom));
+        cpu.run(3);
+        uint16_t expected = Quirks::Of(profile).bigMemory ? 0x1001 : 0x0FFF;
+        if (cpu.get_index() != expected)
+        {
+            std::printf("FX1E under %s: I=%03X, expected %03X\n", Quirks::Name(profile), cpu.get_index(), expected);
+            ++failures;
+        }
+    }
+    return failures;
+}
+} // namespace
+
+int main()
+{
+    unsigned int failures = 0;
+
+    unsigned int decode = checkDecode();
+    std::printf("decode: %s\n", decode ? "FAILED" : "ok");
+    failures += decode;
+
+    unsigned int idle = checkIdle();
+    std::printf("idle: %s\n", idle ? "FAILED" : "ok");
+    failures += idle;
+
+    unsigned int index = checkIndexLimit();
+    std::printf("index: %s\n", index ? "FAILED" : "ok");
+    failures += index;
+
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
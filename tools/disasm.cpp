@@ -0,0 +1,152 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Static disassembler and control-flow summary for ROMs
+ *****************************************************************************/
+
+#include "ControlFlow.hpp"
+#include "Disassembler.hpp"
+#include "RomCatalog.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+enum class Mode
+{
+    LISTING,
+    SUMMARY,
+    DOT
+};
+
+void usage(const char *argv0)
+{
+    std::cerr << "Usage: " << argv0 << " [-s | -g] <ROM|directory> ...\n"
+              << "  (default)  annotated disassembly of each ROM\n"
+              << "  -s         one line per ROM: blocks, code, sprite and data bytes,\n"
+              << "             subroutines and stores that may modify code\n"
+              << "  -g         the control-flow graph in Graphviz dot format\n"
+              << "A directory covers every ROM in it through a cached RomCatalog.\n";
+}
+
+void summarise(const std::string &name, const uint8_t *rom, size_t size, const ControlFlow::Graph &graph)
+{
+    size_t counts[5] = {};
+    for (ControlFlow::Byte b : graph.bytes)
+        ++counts[static_cast<size_t>(b)];
+
+    std::printf("%s size=%zu quirks=%s blocks=%zu subroutines=%zu code=%zu sprites=%zu data=%zu "
+                "unreached=%zu stores=%zu suspect=%zu\n",
+                name.c_str(), size, Quirks::Name(Quirks::Detect(rom, size)), graph.blocks.size(),
+                graph.subroutines.size(),
+                counts[static_cast<size_t>(ControlFlow::Byte::CODE)] + counts[static_cast<size_t>(ControlFlow::Byte::OPERAND)],
+                counts[static_cast<size_t>(ControlFlow::Byte::SPRITE)],
+                counts[static_cast<size_t>(ControlFlow::Byte::DATA)],
+                counts[static_cast<size_t>(ControlFlow::Byte::UNKNOWN)], graph.stores.size(),
+                graph.SuspectStores());
+}
+
+void graphviz(const std::string &name, const ControlFlow::Graph &graph)
+{
+    std::printf("digraph \"%s\" {\n  node [shape=box fontname=monospace];\n", name.c_str());
+    for (const ControlFlow::Block &block : graph.blocks)
+    {
+        bool subroutine = std::binary_search(graph.subroutines.begin(), graph.subroutines.end(), block.start);
+        std::printf("  b%04X [label=\"0x%04X-0x%04X\"%s];\n", block.start, block.start, block.end - 1,
+                    subroutine ? " style=bold" : "");
+        for (uint16_t next : block.successors)
+        {
+            if (graph.BlockAt(next))
+                std::printf("  b%04X -> b%04X;\n", block.start, next);
+        }
+        if (block.terminator == ControlFlow::Terminator::CALL && graph.BlockAt(block.target))
+            std::printf("  b%04X -> b%04X [style=dashed];\n", block.start, block.target);
+    }
+    std::printf("}\n");
+}
+
+void show(Mode mode, const std::string &name, const uint8_t *rom, size_t size)
+{
+    ControlFlow::Graph graph = ControlFlow::Analyse(rom, size);
+    switch (mode)
+    {
+    case Mode::LISTING:
+        std::cout << "; " << name << "\n";
+        Disassembler::Listing(std::cout, rom, size, graph);
+        std::cout << "\n";
+        break;
+    case Mode::SUMMARY:
+        summarise(name, rom, size, graph);
+        break;
+    case Mode::DOT:
+        graphviz(name, graph);
+        break;
+    }
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Mode mode = Mode::LISTING;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-s")
+            mode = Mode::SUMMARY;
+        else if (arg == "-g")
+            mode = Mode::DOT;
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        else
+            paths.push_back(arg);
+    }
+    if (paths.empty())
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    for (const std::string &path : paths)
+    {
+        std::error_code error;
+        if (std::filesystem::is_directory(path, error))
+        {
+            RomCatalog catalog;
+            if (catalog.Open(path) != 0)
+                return EXIT_FAILURE;
+            for (const RomCatalog::Rom &rom : catalog.Roms())
+            {
+                if (rom.fits)
+                    show(mode, rom.name, rom.data, rom.size);
+            }
+            continue;
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            std::cerr << "Failed to open ROM: " << path << "\n";
+            return EXIT_FAILURE;
+        }
+        std::vector<uint8_t> image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        if (image.size() > MEM_SIZE_BYTES - START_ADDRESS)
+        {
+            std::cerr << "ROM too large: " << path << "\n";
+            return EXIT_FAILURE;
+        }
+        show(mode, path, image.data(), image.size());
+    }
+    return EXIT_SUCCESS;
+}
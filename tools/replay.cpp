@@ -0,0 +1,282 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Replays a recorded session headlessly at full host speed
+ *****************************************************************************/
+
+#include "Audio.hpp"
+#include "FrameSink.hpp"
+#include "InputLog.hpp"
+#include "Jit.hpp"
+#include "RomCatalog.hpp"
+#include "Trace.hpp"
+#include "chip8.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void usage(const char *argv0)
+{
+    std::cerr << "Usage: " << argv0 << " [-J] [-r repeats] [-e state] [-o frame.pgm] [-t trace]\n"
+              << "       [-v video [-F format] [-D] [-s skip] [-k every]] [-w audio.wav]\n"
+              << "       <ROM|directory> <session>\n"
+              << "  -J          execute through the x86-64 JIT\n"
+              << "  -r repeats  replay the session this many times from power-on and\n"
+              << "              check every run ends in the same state (default 1)\n"
+              << "  -e state    expected final state hash in hex; exit with failure\n"
+              << "              when the replay ends anywhere else\n"
+              << "  -o file     write the final framebuffer as a binary PGM image\n"
+              << "  -t file     write an execution trace of the first run, for chip8-trace\n"
+              << "  -v file     stream the frames of the first run, interpreted, to file (- for stdout)\n"
+              << "  -F format   y4m (default), raw 1-bpp or pbm\n"
+              << "  -D          raw frames carry only the rows that changed\n"
+              << "  -s skip     leave out this many leading frames\n"
+              << "  -k every    then keep one frame in `every`\n"
+              << "  -w file     write the sound of the first run, interpreted, as a 48 kHz WAV file\n"
+              << "Given a directory, the ROM the session was recorded with is found by its hash.\n";
+}
+
+uint64_t hashVideo(const Processor &chip8)
+{
+    // FNV-1a over the framebuffer
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const auto *bytes = reinterpret_cast<const uint8_t *>(chip8.display);
+    for (size_t i = 0; i < sizeof(chip8.display); ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// One grey byte per pixel at the machine's current resolution
+bool writePgm(const char *filename, const Processor &chip8)
+{
+    std::vector<uint32_t> rgba(chip8.display_width() * chip8.display_height());
+    chip8.render_rgba(rgba.data());
+
+    std::ofstream out(filename, std::ios::binary);
+    out << "P5\n" << chip8.display_width() << ' ' << chip8.display_height() << "\n255\n";
+    for (uint32_t pixel : rgba)
+        out.put(static_cast<char>(pixel & 0xFFu));
+    return static_cast<bool>(out);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bool useJit = false;
+    unsigned int repeats = 1;
+    bool checkState = false;
+    uint64_t expectedState = 0;
+    const char *framePath = nullptr;
+    const char *tracePath = nullptr;
+    const char *videoPath = nullptr;
+    const char *audioPath = nullptr;
+    FrameSink::Options video;
+    video.wait = true; // Nothing is live here, so keep every frame
+    std::vector<const char *> paths;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "-J")
+                useJit = true;
+            else if (arg == "-r" && i + 1 < argc)
+                repeats = static_cast<unsigned int>(std::stoul(argv[++i]));
+            else if (arg == "-e" && i + 1 < argc)
+            {
+                expectedState = std::stoull(argv[++i], nullptr, 16);
+                checkState = true;
+            }
+            else if (arg == "-o" && i + 1 < argc)
+                framePath = argv[++i];
+            else if (arg == "-t" && i + 1 < argc)
+                tracePath = argv[++i];
+            else if (arg == "-v" && i + 1 < argc)
+                videoPath = argv[++i];
+            else if (arg == "-F" && i + 1 < argc)
+            {
+                if (!FrameSink::ParseFormat(argv[++i], video.format))
+                    throw std::invalid_argument(std::string("unknown frame format ") + argv[i]);
+            }
+            else if (arg == "-w" && i + 1 < argc)
+                audioPath = argv[++i];
+            else if (arg == "-D")
+                video.delta = true;
+            else if (arg == "-s" && i + 1 < argc)
+                video.skip = static_cast<unsigned int>(std::stoul(argv[++i]));
+            else if (arg == "-k" && i + 1 < argc)
+                video.every = static_cast<unsigned int>(std::stoul(argv[++i]));
+            else if (!arg.empty() && arg[0] == '-')
+            {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            else
+                paths.push_back(argv[i]);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Invalid argument: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (paths.size() != 2 || repeats == 0)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    InputReplay replay;
+    if (replay.Load(paths[1]) != 0)
+        return EXIT_FAILURE;
+    const SessionInfo &info = replay.Info();
+
+    // A catalog already knows every ROM's hash, so the session picks its own
+    RomCatalog catalog;
+    std::vector<uint8_t> image;
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    std::error_code error;
+    if (std::filesystem::is_directory(paths[0], error))
+    {
+        if (catalog.Open(paths[0]) != 0)
+            return EXIT_FAILURE;
+        const RomCatalog::Rom *found = catalog.Find(info.romHash);
+        if (!found || found->size != info.romSize)
+        {
+            std::cerr << "No ROM in " << paths[0] << " matches the session\n";
+            return EXIT_FAILURE;
+        }
+        data = found->data;
+        size = found->size;
+    }
+    else
+    {
+        std::ifstream rom(paths[0], std::ios::binary);
+        if (!rom.is_open())
+        {
+            std::cerr << "Failed to open ROM: " << paths[0] << "\n";
+            return EXIT_FAILURE;
+        }
+        image.assign(std::istreambuf_iterator<char>(rom), std::istreambuf_iterator<char>());
+        data = image.data();
+        size = image.size();
+        if (info.romSize != size || info.romHash != SessionInfo::HashRom(data, size))
+        {
+            std::cerr << "Session was recorded with a different ROM\n";
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Heap-allocated: a Processor and its JIT are too large for comfort on
+    // the stack
+    std::unique_ptr<Processor> chip8;
+    TraceWriter tracer;
+    if (tracePath && tracer.Open(tracePath) != 0)
+        return EXIT_FAILURE;
+    FrameSink sink;
+    if (videoPath && sink.Open(videoPath, video) != 0)
+        return EXIT_FAILURE;
+    WavWriter wav;
+    if (audioPath && wav.Open(audioPath) != 0)
+        return EXIT_FAILURE;
+    uint64_t firstState = 0;
+    double seconds = 0;
+
+    for (unsigned int run = 0; run < repeats; ++run)
+    {
+        chip8.reset(new Processor());
+        info.Apply(*chip8);
+        if (chip8->load_rom(data, size) != 0)
+            return EXIT_FAILURE;
+        if (run == 0 && tracer.IsOpen())
+            chip8->set_tracer(&tracer);
+
+        auto begin = std::chrono::steady_clock::now();
+        if (run == 0 && (sink.IsOpen() || wav.IsOpen()))
+        {
+            // Frames come from the interpreter, which can stop at each one
+            Processor &cpu = *chip8;
+            replay.Play(cpu, [&cpu, &sink, &wav](uint64_t cycles)
+                        {
+                while (cycles > 0)
+                {
+                    RunResult result = cpu.run(cycles, STOP_FRAME);
+                    cycles -= result.cycles;
+                    if (result.reason != Exit::FRAME)
+                        continue;
+                    if (sink.IsOpen())
+                        sink.Capture(cpu);
+                    wav.Write(cpu);
+                } });
+        }
+        else if (useJit)
+        {
+            std::unique_ptr<Jit> jit(new Jit(*chip8));
+            replay.Play(*chip8, [&jit](uint64_t cycles) { jit->run(cycles); });
+        }
+        else
+        {
+            Processor &cpu = *chip8;
+            replay.Play(cpu, [&cpu](uint64_t cycles) { cpu.run(cycles); });
+        }
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        if (run == 0 && tracer.IsOpen())
+        {
+            chip8->set_tracer(nullptr);
+            if (tracer.Close() != 0)
+                return EXIT_FAILURE;
+        }
+        if (run == 0 && (sink.Close() != 0 || wav.Close() != 0))
+            return EXIT_FAILURE;
+
+        uint64_t state = chip8->state_hash();
+        if (run == 0)
+            firstState = state;
+        else if (state != firstState)
+        {
+            std::fprintf(stderr, "Run %u ended in state %016llx, run 0 in %016llx\n", run,
+                         static_cast<unsigned long long>(state), static_cast<unsigned long long>(firstState));
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Keep the summary out of a frame stream on standard output
+    std::FILE *report = videoPath && std::strcmp(videoPath, "-") == 0 ? stderr : stdout;
+    uint64_t total = replay.EndCycle() * repeats;
+    std::fprintf(report, "cycles=%llu events=%zu runs=%u time=%.3fs ips=%.0f video=%016llx state=%016llx\n",
+                static_cast<unsigned long long>(replay.EndCycle()), replay.Events().size(), repeats,
+                seconds, seconds > 0 ? total / seconds : 0.0,
+                static_cast<unsigned long long>(hashVideo(*chip8)),
+                static_cast<unsigned long long>(firstState));
+
+    if (framePath && !writePgm(framePath, *chip8))
+    {
+        std::cerr << "Failed to write frame: " << framePath << "\n";
+        return EXIT_FAILURE;
+    }
+    if (checkState && firstState != expectedState)
+    {
+        std::fprintf(stderr, "Expected state %016llx\n", static_cast<unsigned long long>(expectedState));
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
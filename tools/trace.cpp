@@ -0,0 +1,130 @@
+/******************************************************************************
+ * CHIP-8 Emulator
+ * Author: Soham Dhar
+ * Date: 2026-10-17
+ *
+ * Description: Decodes and filters an execution trace into disassembly
+ *****************************************************************************/
+
+#include "Disassembler.hpp"
+#include "Trace.hpp"
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+void usage(const char *argv0)
+{
+    std::cerr << "Usage: " << argv0 << " [-a addr[-addr]] [-c cycle[-cycle]] [-o op]... [-n lines] <trace>\n"
+              << "  -a range  only instructions at these addresses (hex, inclusive)\n"
+              << "  -c range  only instructions started in this cycle range (inclusive)\n"
+              << "  -o op     only this handler, e.g. Dxyn or OP_Fx0a; may be repeated\n"
+              << "  -n lines  stop after printing this many instructions\n";
+}
+
+struct Range
+{
+    uint64_t first = 0;
+    uint64_t last = UINT64_MAX;
+
+    bool Contains(uint64_t v) const { return v >= first && v <= last; }
+};
+
+Range parseRange(const std::string &text, int base)
+{
+    Range range;
+    size_t dash = text.find('-');
+    range.first = std::stoull(text.substr(0, dash), nullptr, base);
+    range.last = dash == std::string::npos ? range.first : std::stoull(text.substr(dash + 1), nullptr, base);
+    return range;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Range addresses;
+    Range cycles;
+    std::vector<Op> ops;
+    uint64_t limit = UINT64_MAX;
+    const char *path = nullptr;
+
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            if (arg == "-a" && i + 1 < argc)
+                addresses = parseRange(argv[++i], 16);
+            else if (arg == "-c" && i + 1 < argc)
+                cycles = parseRange(argv[++i], 10);
+            else if (arg == "-o" && i + 1 < argc)
+            {
+                Op op;
+                if (!Disassembler::ParseOpName(argv[++i], op))
+                    throw std::invalid_argument(std::string("unknown handler ") + argv[i]);
+                ops.push_back(op);
+            }
+            else if (arg == "-n" && i + 1 < argc)
+                limit = std::stoull(argv[++i]);
+            else if (!path && !arg.empty() && arg[0] != '-')
+                path = argv[i];
+            else
+            {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Invalid argument: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (!path)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::vector<TraceRecord> records;
+    if (LoadTrace(path, records) != 0)
+        return EXIT_FAILURE;
+
+    uint64_t printed = 0;
+    uint64_t expected = records.empty() ? 0 : records.front().cycle;
+    for (const TraceRecord &r : records)
+    {
+        // Idle loops the interpreter fast-forwarded leave gaps in the count
+        uint64_t skipped = r.cycle > expected ? r.cycle - expected : 0;
+        expected = r.cycle + 1;
+
+        Instr in = Processor::decode(r.opcode);
+        if (!addresses.Contains(r.pc) || !cycles.Contains(r.cycle))
+            continue;
+        if (!ops.empty())
+        {
+            bool wanted = false;
+            for (Op op : ops)
+                wanted |= op == in.op;
+            if (!wanted)
+                continue;
+        }
+
+        if (printed == limit)
+            break;
+        if (skipped)
+        {
+            std::printf("%12s  ... %llu idle instructions fast-forwarded\n", "",
+                        static_cast<unsigned long long>(skipped));
+        }
+        std::printf("%12llu  %04X  %04X  %-16s V%X=%02X VF=%02X I=%04X\n",
+                    static_cast<unsigned long long>(r.cycle), r.pc, r.opcode,
+                    Disassembler::Format(r.opcode).c_str(), in.x, r.vx, r.vf, r.index);
+        ++printed;
+    }
+    return EXIT_SUCCESS;
+}